@@ -0,0 +1,196 @@
+// Scaling benchmark for the schedulers in simulator.cpp.
+//
+//   g++ -std=c++17 -O2 -pthread sched_bench.cpp -o sched_bench
+//   ./sched_bench --json bench.json
+//
+// Every scheduler runs on generated workloads of 10^2, 10^3, ... jobs in each
+// regime. A run is repeated until it has taken --min-time seconds, and the mean
+// is reported. The output is ns per scheduling decision (one Gantt block), peak
+// RSS and a fitted scaling exponent (time ~ n^k). The JSON has one benchmark per
+// line, so two versions can be compared with a plain diff.
+#define SIMULATOR_NO_MAIN
+#include "simulator.cpp"
+
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+// Load is CPU demand per time unit, so the ready queue stays bounded below 1
+// and grows linearly above it.
+struct Regime { const char* name; const char* arrival; const char* burst; double mean_burst, load; int io_bursts; double mean_io; };
+const Regime REGIMES[] = {
+    {"uniform",   "poisson", "uniform", 5,   0.9, 0, 0},
+    {"heavytail", "bursty",  "pareto",  5,   0.9, 0, 0},
+    {"overload",  "poisson", "exp",     5,   1.5, 0, 0},
+    {"long",      "uniform", "bimodal", 100, 0.9, 0, 0},
+    {"io",        "poisson", "uniform", 5,   0.9, 2, 4},
+};
+
+// /proc/self/status fields in kB, or -1 where there is no procfs.
+long long procStatusKb(const char* field) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) return -1;
+    char line[256]; long long kb = -1; size_t len = strlen(field);
+    while (fgets(line, sizeof line, f))
+        if (!strncmp(line, field, len) && line[len] == ':') { kb = atoll(line + len + 1); break; }
+    fclose(f);
+    return kb;
+}
+
+// Writing 5 to clear_refs resets VmHWM to the current RSS (Linux 4.0+), so each
+// run's peak is its own. If that fails the peak is the process-wide one.
+bool resetPeakRss() {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0) return false;
+    bool ok = write(fd, "5", 1) == 1;
+    close(fd);
+    return ok;
+}
+
+struct Result {
+    std::string sched, regime; long long n = 0; size_t decisions = 0; int iterations = 0;
+    double ms = 0, ns_per_decision = 0; long long peak_rss_kb = -1, run_rss_kb = -1;
+};
+
+// Least-squares slope of log(ms) against log(n). The smallest sizes are mostly
+// fixed overhead, so only n >= 10^4 is used when there are two such points.
+double scalingExponent(const std::vector<const Result*>& rs) {
+    std::vector<const Result*> pts;
+    for (auto* r : rs) if (r->n >= 10000) pts.push_back(r);
+    if (pts.size() < 2) pts = rs;
+    if (pts.size() < 2) return NAN;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, k = (double)pts.size();
+    for (auto* r : pts) {
+        double x = std::log((double)r->n), y = std::log(std::max(r->ms, 1e-6));
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+    }
+    return (k * sxy - sx * sy) / (k * sxx - sx * sx);
+}
+
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    for (size_t pos = 0; pos <= s.size(); ) {
+        size_t comma = std::min(s.find(',', pos), s.size());
+        out.push_back(s.substr(pos, comma - pos)); pos = comma + 1;
+    }
+    return out;
+}
+
+std::string jsonNum(double v) {
+    if (!std::isfinite(v)) return "null";
+    std::ostringstream o; o << std::setprecision(6) << v; return o.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::map<std::string,std::string> args;
+    for (int i = 1; i + 1 < argc; i += 2) args[argv[i]] = argv[i + 1];
+    long long max_n = args["--max-n"].empty() ? 10000000 : std::stoll(args["--max-n"]);
+    long long min_n = args["--min-n"].empty() ? 100 : std::stoll(args["--min-n"]);
+    double min_time = args["--min-time"].empty() ? 0.2 : std::stod(args["--min-time"]);
+    uint64_t seed = args["--seed"].empty() ? 42 : std::stoull(args["--seed"]);
+    if (!args["--threads"].empty()) g_threads = (unsigned)std::stoul(args["--threads"]);
+    std::vector<std::string> scheds = ALL_SCHEDULERS;
+    if (!args["--scheduler"].empty() && args["--scheduler"] != "all") scheds = splitList(args["--scheduler"]);
+    for (auto& name : scheds) if (!makeScheduler(name)) { std::cerr<<"Unknown scheduler: "<<name<<"\n"; return 1; }
+    std::vector<const Regime*> regimes;
+    for (auto& r : REGIMES) regimes.push_back(&r);
+    if (!args["--regime"].empty()) {
+        regimes.clear();
+        for (auto& name : splitList(args["--regime"])) {
+            auto it = std::find_if(std::begin(REGIMES), std::end(REGIMES), [&](const Regime& r){ return name == r.name; });
+            if (it == std::end(REGIMES)) { std::cerr<<"Unknown regime: "<<name<<"\n"; return 1; }
+            regimes.push_back(&*it);
+        }
+    }
+    if (min_n < 1 || max_n < min_n || max_n > INT_MAX || min_time < 0) { std::cerr<<"Bad --min-n/--max-n/--min-time\n"; return 1; }
+    bool rss_per_run = resetPeakRss();
+    if (!rss_per_run) std::cerr<<"Cannot reset VmHWM; peak RSS is process-wide\n";
+
+    std::vector<Result> results;
+    std::cout<<std::left<<std::setw(10)<<"regime"<<std::setw(9)<<"sched"<<std::right<<std::setw(10)<<"n"
+             <<std::setw(12)<<"decisions"<<std::setw(6)<<"iters"<<std::setw(12)<<"ms"<<std::setw(10)<<"ns/dec"
+             <<std::setw(12)<<"peak_kb"<<std::setw(11)<<"run_kb"<<"\n";
+    for (const Regime* rg : regimes)
+        for (long long n = min_n; n <= max_n; n *= 10) {
+            // one workload per (regime, n), shared by every scheduler
+            GenSpec spec; spec.n = n; spec.seed = seed;
+            spec.arrival = rg->arrival; spec.burst = rg->burst; spec.mean_burst = rg->mean_burst;
+            spec.io_bursts = rg->io_bursts; spec.mean_io = std::max(1.0, rg->mean_io);
+            spec.rate = rg->load / (rg->mean_burst * (rg->io_bursts + 1));
+            IdTable ids;
+            Workload ps = generateRandomProcesses(spec, ids);
+            if (ps.size() != (size_t)n) return 1;
+            for (auto& name : scheds) {
+                Result r; r.sched = name; r.regime = rg->name; r.n = n;
+                SchedConfig cfg; cfg.seed = seed;   // lottery draws
+                auto scheduler = makeScheduler(name, cfg);
+                RunArena arena(runFootprint(ps, false));   // reused by every iteration, as in a --sweep worker
+                double total_ms = 0;
+                do {
+                    if (r.iterations) arena.reset();
+                    RunState st(arena.get());
+                    Gantt gantt(nullptr);   // count decisions only
+                    int total_time = 0;
+                    long long base_kb = 0;
+                    if (r.iterations == 0 && rss_per_run) { resetPeakRss(); base_kb = procStatusKb("VmRSS"); }
+                    auto t0 = std::chrono::steady_clock::now();
+                    scheduler->schedule(ps, st, gantt, total_time);
+                    total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    if (r.iterations++ == 0) {
+                        r.decisions = gantt.size();
+                        r.peak_rss_kb = procStatusKb("VmHWM");
+                        if (rss_per_run && base_kb >= 0 && r.peak_rss_kb >= 0) r.run_rss_kb = r.peak_rss_kb - base_kb;
+                    }
+                } while (total_ms < min_time * 1e3);
+                r.ms = total_ms / r.iterations;
+                r.ns_per_decision = r.decisions ? r.ms * 1e6 / r.decisions : 0;
+                std::cout<<std::left<<std::setw(10)<<r.regime<<std::setw(9)<<r.sched<<std::right<<std::setw(10)<<r.n
+                         <<std::setw(12)<<r.decisions<<std::setw(6)<<r.iterations<<std::setw(12)<<std::setprecision(4)<<r.ms
+                         <<std::setw(10)<<r.ns_per_decision<<std::setw(12)<<r.peak_rss_kb<<std::setw(11)<<r.run_rss_kb<<std::endl;
+                results.push_back(r);
+            }
+        }
+
+    struct Fit { std::string sched, regime; double k; };
+    std::vector<Fit> fits;
+    std::cout<<"\nScaling exponent (ms ~ n^k)\n"<<std::left<<std::setw(10)<<"regime";
+    for (auto& name : scheds) std::cout<<std::right<<std::setw(9)<<name;
+    std::cout<<"\n";
+    for (const Regime* rg : regimes) {
+        std::cout<<std::left<<std::setw(10)<<rg->name;
+        for (auto& name : scheds) {
+            std::vector<const Result*> rs;
+            for (auto& r : results) if (r.sched == name && r.regime == rg->name) rs.push_back(&r);
+            fits.push_back({name, rg->name, scalingExponent(rs)});
+            std::cout<<std::right<<std::setw(9)<<std::fixed<<std::setprecision(2)<<fits.back().k<<std::defaultfloat;
+        }
+        std::cout<<"\n";
+    }
+
+    if (!args["--json"].empty()) {
+        std::ofstream f;
+        bool to_stdout = args["--json"] == "-";
+        if (!to_stdout) { f.open(args["--json"]); if (!f) { std::cerr<<"Cannot write "<<args["--json"]<<"\n"; return 1; } }
+        std::ostream& o = to_stdout ? std::cout : f;
+        o<<"{\n  \"context\": {\"seed\": "<<seed<<", \"min_time_s\": "<<jsonNum(min_time)
+         <<", \"threads\": "<<threadCount()<<", \"rss_per_run\": "<<(rss_per_run ? "true" : "false")<<"},\n";
+        o<<"  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            o<<"    {\"name\": \""<<r.sched<<"/"<<r.regime<<"/"<<r.n<<"\", \"scheduler\": \""<<r.sched
+             <<"\", \"regime\": \""<<r.regime<<"\", \"n\": "<<r.n<<", \"decisions\": "<<r.decisions
+             <<", \"iterations\": "<<r.iterations<<", \"real_time_ms\": "<<jsonNum(r.ms)
+             <<", \"ns_per_decision\": "<<jsonNum(r.ns_per_decision)<<", \"peak_rss_kb\": "<<r.peak_rss_kb
+             <<", \"run_rss_kb\": "<<r.run_rss_kb<<"}"<<(i + 1 < results.size() ? "," : "")<<"\n";
+        }
+        o<<"  ],\n  \"scaling\": [\n";
+        for (size_t i = 0; i < fits.size(); ++i)
+            o<<"    {\"scheduler\": \""<<fits[i].sched<<"\", \"regime\": \""<<fits[i].regime<<"\", \"exponent\": "
+             <<jsonNum(fits[i].k)<<"}"<<(i + 1 < fits.size() ? "," : "")<<"\n";
+        o<<"  ]\n}\n";
+    }
+    return 0;
+}
@@ -9,143 +9,821 @@
 #include <random>
 #include <chrono>
 #include <map>
+#include <set>
 #include <memory>
+#include <memory_resource>
+#include <deque>
+#include <optional>
+#include <new>
 #include <climits>
+#include <cstdint>
+#include <iomanip>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <tuple>
+#include <cstring>
+#include <charconv>
+#include <string_view>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
+// Process names are interned at load time; everything past the loader works on
+// 32-bit handles and names are only looked up again when printing.
+using ProcId = uint32_t;
+constexpr ProcId NO_ID   = UINT32_MAX;      // "no block open"
+constexpr ProcId IDLE_ID = UINT32_MAX - 1;  // CPU idle in the Gantt chart
+constexpr ProcId MIGRATE_ID = UINT32_MAX - 2; // CPU busy moving a stolen job (--cpus)
+constexpr ProcId SWITCH_ID = UINT32_MAX - 3;  // context-switch overhead (--switch-cost, --warmup)
+
+// One row of a workload, only used while building one (parsers, generators).
 struct Process {
-    std::string id;
+    ProcId id;
     int arrival_time;
     int burst_time;
     int priority;              // lower = higher
-    int remaining_time = 0;
-    int waiting_time = 0;
-    int turnaround_time = 0;
     int deadline = 0;          // for EDF
-    double vruntime = 0.0;     // for CFS
 };
 
-void calculateMetrics(const std::vector<Process>& ps, int total_time,
-                      double& avg_wait, double& avg_turn, double& cpu_util, double& throughput) {
-    avg_wait = 0; avg_turn = 0;
-    for (auto& p : ps) { avg_wait += p.waiting_time; avg_turn += p.turnaround_time; }
-    int n = (int)ps.size();
-    avg_wait /= n; avg_turn /= n;
-    int busy = std::accumulate(ps.begin(), ps.end(), 0,
-                               [](int s, const Process& p){ return s + p.burst_time; });
-    cpu_util = total_time ? (double)busy / total_time * 100.0 : 0.0;
-    throughput = total_time ? (double)n / total_time : 0.0;
+// Allocator for cache-line-aligned columns.
+template <class T> struct CacheAligned {
+    using value_type = T;
+    CacheAligned() = default;
+    template <class U> CacheAligned(const CacheAligned<U>&) {}
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(64))); }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(64)); }
+    template <class U> bool operator==(const CacheAligned<U>&) const { return true; }
+    template <class U> bool operator!=(const CacheAligned<U>&) const { return false; }
+};
+template <class T> using Column = std::vector<T, CacheAligned<T>>;
+
+// The workload as one 64-byte-aligned int32 column per field, so a scheduler that
+// only looks at arrivals (or metrics that only sum bursts) streams 4 bytes per job
+// instead of whole rows. Columns are either owned (push_back) or borrowed from a
+// mapped binary workload (borrow), and schedulers only see the const pointers.
+//
+// A job may alternate CPU and I/O bursts (CPU, IO, CPU, ..., CPU). Then burst[i]
+// is its total CPU time, io[i] its total I/O time, and its bursts in order are
+// seq[seq_off[i] .. seq_off[i+1]). Those three stay null while every job is a
+// single CPU burst, so plain workloads pay nothing for them.
+class Workload {
+    size_t n = 0;
+    Column<ProcId> own_id;
+    Column<int32_t> own_arrival, own_burst, own_priority, own_deadline;
+    Column<uint64_t> own_seq_off;
+    Column<int32_t> own_seq, own_io;
+    bool owned = true;
+    void bind() {
+        if (!owned) return;
+        id = own_id.data(); arrival = own_arrival.data(); burst = own_burst.data();
+        priority = own_priority.data(); deadline = own_deadline.data();
+        if (!own_seq_off.empty()) { seq_off = own_seq_off.data(); seq = own_seq.data(); io = own_io.data(); }
+    }
+    // First multi-burst job: every job so far becomes a one-burst sequence.
+    void startSequences() {
+        own_seq_off.reserve(own_id.capacity() + 1); own_seq.reserve(own_id.capacity());
+        own_seq_off.push_back(0);
+        for (size_t i = 0; i < n; ++i) { own_seq.push_back(own_burst[i]); own_seq_off.push_back(own_seq.size()); }
+        own_io.assign(n, 0);
+    }
+public:
+    const ProcId* id = nullptr;
+    const int32_t *arrival = nullptr, *burst = nullptr, *priority = nullptr, *deadline = nullptr;
+    const uint64_t* seq_off = nullptr;
+    const int32_t *seq = nullptr, *io = nullptr;
+
+    Workload() = default;
+    Workload(const Workload&) = delete;
+    Workload& operator=(const Workload&) = delete;
+    Workload(Workload&& o) noexcept { *this = std::move(o); }
+    Workload& operator=(Workload&& o) noexcept {
+        n = o.n; owned = o.owned;
+        own_id = std::move(o.own_id); own_arrival = std::move(o.own_arrival); own_burst = std::move(o.own_burst);
+        own_priority = std::move(o.own_priority); own_deadline = std::move(o.own_deadline);
+        own_seq_off = std::move(o.own_seq_off); own_seq = std::move(o.own_seq); own_io = std::move(o.own_io);
+        id = o.id; arrival = o.arrival; burst = o.burst; priority = o.priority; deadline = o.deadline;
+        seq_off = o.seq_off; seq = o.seq; io = o.io;
+        bind(); o.n = 0;
+        return *this;
+    }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    void clear() { *this = Workload(); }
+    void reserve(size_t cap) {
+        own_id.reserve(cap); own_arrival.reserve(cap); own_burst.reserve(cap);
+        own_priority.reserve(cap); own_deadline.reserve(cap); bind();
+    }
+    void push_back(const Process& p) {
+        own_id.push_back(p.id); own_arrival.push_back(p.arrival_time); own_burst.push_back(p.burst_time);
+        own_priority.push_back(p.priority); own_deadline.push_back(p.deadline);
+        if (!own_seq_off.empty()) { own_seq.push_back(p.burst_time); own_seq_off.push_back(own_seq.size()); own_io.push_back(0); }
+        ++n; bind();
+    }
+    // A job with bursts b[0..k): CPU, IO, CPU, ... (k odd). p.burst_time is ignored.
+    void push_back(Process p, const int32_t* b, size_t k) {
+        if (k == 1) { p.burst_time = b[0]; push_back(p); return; }
+        if (own_seq_off.empty()) startSequences();
+        long long cpu = 0, wait = 0;
+        for (size_t j = 0; j < k; ++j) (j % 2 ? wait : cpu) += b[j];
+        p.burst_time = (int)cpu;
+        own_seq.insert(own_seq.end(), b, b + k); own_seq_off.push_back(own_seq.size()); own_io.push_back((int)wait);
+        own_id.push_back(p.id); own_arrival.push_back(p.arrival_time); own_burst.push_back(p.burst_time);
+        own_priority.push_back(p.priority); own_deadline.push_back(p.deadline);
+        ++n; bind();
+    }
+    // Point at columns that live elsewhere (a mapping); nothing is copied.
+    void borrow(size_t count, const ProcId* ids, const int32_t* arr, const int32_t* bur, const int32_t* pri, const int32_t* dl) {
+        *this = Workload(); owned = false; n = count;
+        id = ids; arrival = arr; burst = bur; priority = pri; deadline = dl;
+    }
+    // Owned workloads only: rewrite the id column (IdTable::finalize).
+    template <class F> void remapIds(F f) { for (auto& v : own_id) v = f(v); }
+    // Owned workloads only: stable sort the rows by arrival if they are not already.
+    void sortByArrival() {
+        if (std::is_sorted(own_arrival.begin(), own_arrival.end())) return;
+        std::vector<size_t> ord(n); std::iota(ord.begin(), ord.end(), 0);
+        std::stable_sort(ord.begin(), ord.end(), [&](size_t a, size_t b){ return own_arrival[a] < own_arrival[b]; });
+        auto permute = [&](auto& col){ auto out = col; for (size_t i = 0; i < n; ++i) out[i] = col[ord[i]]; col.swap(out); };
+        permute(own_id); permute(own_arrival); permute(own_burst); permute(own_priority); permute(own_deadline);
+        if (!own_seq_off.empty()) {
+            permute(own_io);
+            Column<uint64_t> off(1, 0); Column<int32_t> out; off.reserve(n + 1); out.reserve(own_seq.size());
+            for (size_t i = 0; i < n; ++i) {
+                out.insert(out.end(), own_seq.begin() + own_seq_off[ord[i]], own_seq.begin() + own_seq_off[ord[i] + 1]);
+                off.push_back(out.size());
+            }
+            own_seq_off.swap(off); own_seq.swap(out);
+        }
+        bind();
+    }
+};
+
+// The job a CPU last dispatched, when it started running and its remaining
+// time then (so the time it left the CPU can be worked out later).
+struct CpuContext { int last = -1, since = 0, rem = 0; };
+
+// Memory for one simulation run. A pool (for nodes that come and go: set
+// entries, deque chunks) sits on a monotonic buffer, and reset() drops the
+// whole run at once. The buffer is kept between runs and regrown to cover
+// whatever the last run had to fetch from the global heap, so a thread that
+// runs many simulations back to back stops allocating after its first one.
+class RunArena {
+    // the global heap behind the buffer; counts what the buffer could not hold
+    class Overflow : public std::pmr::memory_resource {
+        void* do_allocate(size_t n, size_t a) override { bytes += n; return std::pmr::new_delete_resource()->allocate(n, a); }
+        void do_deallocate(void* p, size_t n, size_t a) override { std::pmr::new_delete_resource()->deallocate(p, n, a); }
+        bool do_is_equal(const memory_resource& o) const noexcept override { return this == &o; }
+    public:
+        size_t bytes = 0;
+    };
+    std::unique_ptr<std::byte[]> buf; size_t cap;
+    Overflow heap;
+    std::optional<std::pmr::monotonic_buffer_resource> mono;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool;
+    void build() {
+        buf = std::make_unique<std::byte[]>(cap);
+        mono.emplace(buf.get(), cap, &heap);
+        pool.emplace(&*mono);
+    }
+public:
+    explicit RunArena(size_t bytes = 1 << 16) : cap(bytes) { build(); }
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+    std::pmr::memory_resource* get() { return &*pool; }
+    size_t capacity() const { return cap; }
+    // Grow the buffer to at least `bytes` up front. Only between runs.
+    void reserve(size_t bytes) {
+        if (bytes <= cap) return;
+        pool.reset(); mono.reset();
+        cap = bytes; heap.bytes = 0;
+        build();
+    }
+    // Everything allocated from get() must be gone by now.
+    void reset() {
+        pool->release();
+        if (!heap.bytes) { mono->release(); return; }   // back to the start of the buffer
+        pool.reset(); mono.reset();
+        cap += heap.bytes; heap.bytes = 0;
+        build();
+    }
+};
+
+// What one run takes from its arena, so the buffer can be sized before the
+// first run: per job, the RunState columns and the largest scheduler's queues,
+// heaps and timers (cfs, mlq, mlfq), with room for the pool's chunks and for
+// vectors that double inside the monotonic buffer. A kept chart gets
+// GANTT_BLOCKS_PER_BURST blocks per CPU burst reserved up front; a schedule
+// that cuts bursts into more blocks than that grows it from the heap.
+constexpr size_t RUN_BYTES_BASE = 1 << 16, RUN_BYTES_PER_JOB = 192;
+constexpr size_t GANTT_BLOCKS_PER_BURST = 8;
+static size_t cpuBursts(const Workload& ps) {
+    return ps.seq_off ? (size_t)(ps.seq_off[ps.size()] + ps.size()) / 2 : ps.size();
+}
+static size_t runFootprint(const Workload& ps, bool keep_chart) {
+    size_t bytes = RUN_BYTES_BASE + ps.size() * RUN_BYTES_PER_JOB;
+    if (keep_chart) bytes += cpuBursts(ps) * GANTT_BLOCKS_PER_BURST * sizeof(std::pair<ProcId,int>);
+    return bytes;
 }
 
-void printGantt(const std::vector<std::pair<std::string,int>>& gantt) {
-    std::cout << "Gantt Chart: ";
-    for (auto& e : gantt) std::cout << "(" << e.first << " " << e.second << ") ";
-    std::cout << "\n";
+// Everything a scheduler writes during one run. The workload itself is shared
+// read-only, so several schedulers can run on it at once. The columns and all
+// of a scheduler's queues come from `mem` (a RunArena, or the global heap).
+struct RunState {
+    std::pmr::memory_resource* mem;
+    std::pmr::vector<int> remaining, waiting, turnaround;
+    std::pmr::vector<int> response;   // first dispatch - arrival, -1 until the job first runs
+    CpuContext cpu;                               // single-CPU schedulers
+    std::pmr::vector<int> left, on;               // --warmup: when/where each job last ran (-1: never)
+    long long switches = 0, switch_time = 0;
+    std::pmr::vector<uint32_t> phase;             // I/O workloads: index of the current CPU burst in ps.seq
+    long long io_busy = 0;                        // time the I/O device was busy
+    explicit RunState(std::pmr::memory_resource* m = std::pmr::get_default_resource())
+        : mem(m), remaining(m), waiting(m), turnaround(m), response(m), left(m), on(m), phase(m) {}
+};
+
+// Hot-path counters for --stats, only in builds with -DSIM_STATS; otherwise the
+// SIM_STAT* macros expand to nothing. They are thread_local, so the parallel
+// `all`/--sweep runs never share them; --stats reports the single-run path.
+// These builds also replace global operator new to count heap allocations.
+#ifdef SIM_STATS
+struct SimStats {
+    long long decisions = 0;     // dispatches
+    long long pushes = 0, pops = 0;
+    long long max_ready = 0;     // deepest ready queue seen at a dispatch
+    long long preemptions = 0;   // a job taken off the CPU with its burst unfinished
+    long long idle_jumps = 0, blocks = 0;
+    long long allocs = 0;        // global operator new calls on this thread
+    double load_ms = 0, schedule_ms = 0, metrics_ms = 0, print_ms = 0;
+    long long load_allocs = 0, schedule_allocs = 0, metrics_allocs = 0, print_allocs = 0;
+};
+static thread_local SimStats g_sim_stats;
+class SimPhaseTimer {
+    double& ms; long long& allocs;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now(); long long a0 = g_sim_stats.allocs;
+public:
+    SimPhaseTimer(double& m, long long& a) : ms(m), allocs(a) {}
+    ~SimPhaseTimer() {
+        ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        allocs += g_sim_stats.allocs - a0;
+    }
+};
+void* operator new(size_t n) {
+    ++g_sim_stats.allocs;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t n, std::align_val_t a) {
+    ++g_sim_stats.allocs;
+    size_t al = std::max(sizeof(void*), (size_t)a);
+    if (void* p = aligned_alloc(al, (n + al - 1) / al * al)) return p;
+    throw std::bad_alloc();
 }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { free(p); }
+#define SIM_STAT(field) (++g_sim_stats.field)
+#define SIM_STAT_MAX(field, v) (g_sim_stats.field = std::max<long long>(g_sim_stats.field, (v)))
+#define SIM_PHASE(name) SimPhaseTimer sim_phase_##name(g_sim_stats.name##_ms, g_sim_stats.name##_allocs)
+#else
+#define SIM_STAT(field) ((void)0)
+#define SIM_STAT_MAX(field, v) ((void)0)
+#define SIM_PHASE(name) ((void)0)
+#endif
+
+// Where Gantt blocks go as a scheduler emits them (a trace file, ...). Blocks
+// on one CPU are back to back, so a sink that needs timestamps sums the lengths
+// per CPU. Counters are sampled values (ready-queue length, MLFQ level) at
+// simulated time t.
+class GanttSink {
+public:
+    virtual ~GanttSink() = default;
+    virtual void block(int cpu, ProcId id, int len) = 0;
+    virtual void counter(int cpu, const char* name, int t, long long value) { (void)cpu; (void)name; (void)t; (void)value; }
+};
 
-void printResults(const std::vector<Process>& processes, int total_time,
-                  const std::vector<std::pair<std::string,int>>& gantt) {
-    double avg_wait, avg_turn, cpu_util, throughput;
-    calculateMetrics(processes, total_time, avg_wait, avg_turn, cpu_util, throughput);
-    printGantt(gantt);
-    std::cout << "Average Waiting Time: "  << avg_wait   << "\n";
-    std::cout << "Average Turnaround Time: " << avg_turn << "\n";
-    std::cout << "CPU Utilization: "       << cpu_util   << "%\n";
-    std::cout << "Throughput: "            << throughput << " processes/unit time\n";
+// Counter names for Gantt::counter(); sinks key on the pointer. "ready queue" is
+// the number of jobs that have arrived and are waiting, sampled at each dispatch.
+constexpr const char* CTR_READY = "ready queue";
+constexpr const char* CTR_MLFQ_LEVEL = "mlfq level";
+
+// The schedulers' output, one per CPU. By default the blocks are kept for
+// printGantt(); Gantt(sink, cpu) hands each block to the sink (if any) instead
+// and only counts them, so large runs need not hold or format the whole chart.
+class Gantt {
+    std::pmr::vector<std::pair<ProcId,int>> blocks;
+    GanttSink* sink = nullptr; bool keep = true; size_t count = 0; int cpu = 0;
+public:
+    Gantt() = default;
+    explicit Gantt(std::pmr::polymorphic_allocator<std::pair<ProcId,int>> mem) : blocks(mem) {}   // keep blocks in a RunArena
+    explicit Gantt(GanttSink* s, int lane = 0) : sink(s), keep(false), cpu(lane) {}
+    void reserve(size_t n) { if (keep) blocks.reserve(n); }
+    void emplace_back(ProcId id, int len) {
+        ++count; SIM_STAT(blocks);
+        if (id == IDLE_ID) SIM_STAT(idle_jumps);
+        if (sink) sink->block(cpu, id, len);
+        if (keep) blocks.emplace_back(id, len);
+    }
+    void counter(const char* name, int t, long long value) {
+        if (name == CTR_READY) SIM_STAT_MAX(max_ready, value);
+        if (sink) sink->counter(cpu, name, t, value);
+    }
+    size_t size() const { return count; }
+    bool stored() const { return keep; }
+    auto begin() const { return blocks.begin(); }
+    auto end() const { return blocks.end(); }
+};
+
+// Name table for ProcIds. The loaders intern() every name, then finalize()
+// renumbers the handles in sorted name order, so `a.id < b.id` is the same
+// tie-break as comparing the names and no scheduler ever touches a string.
+// Names longer than the small-string buffer come from `mem`; names are never
+// freed one at a time, so main backs it with a monotonic arena.
+class IdTable {
+    std::pmr::vector<std::pmr::string> names;
+    // set by attach(): names read in place from a binary workload's string table
+    const uint64_t* mapped_index = nullptr; const char* mapped_bytes = nullptr; size_t mapped_count = 0;
+public:
+    explicit IdTable(std::pmr::memory_resource* mem = std::pmr::get_default_resource()) : names(mem) {}
+    void reserve(size_t n) { names.reserve(n); }
+    ProcId intern(std::string_view name) { names.emplace_back(name); return (ProcId)(names.size()-1); }
+    void finalize(Workload& ps) {
+        // sort on the first 8 bytes packed big-endian into an integer, and only
+        // fall back to a full string compare when those are equal
+        struct Key { uint64_t prefix; ProcId idx; };
+        std::vector<Key> keys(names.size());
+        for (size_t i=0;i<names.size();++i) {
+            uint64_t k=0;
+            for (size_t b=0;b<8;++b) k=(k<<8)|(b<names[i].size()? (unsigned char)names[i][b] : 0);
+            keys[i]={k,(ProcId)i};
+        }
+        std::sort(keys.begin(), keys.end(), [&](const Key& a, const Key& b){
+            if (a.prefix!=b.prefix) return a.prefix<b.prefix;
+            return names[a.idx]<names[b.idx];
+        });
+        std::vector<ProcId> remap(names.size());
+        std::pmr::vector<std::pmr::string> sorted(names.get_allocator()); sorted.reserve(names.size());
+        for (auto& key : keys) {
+            ProcId k=key.idx;
+            if (sorted.empty() || sorted.back()!=names[k]) sorted.push_back(std::move(names[k]));
+            remap[k]=(ProcId)(sorted.size()-1);
+        }
+        names.swap(sorted);
+        ps.remapIds([&](ProcId v){ return remap[v]; });
+    }
+    // Use an already-sorted string table (offsets index[0..count], bytes) without copying it.
+    void attach(const uint64_t* index, const char* bytes, size_t count) {
+        mapped_index=index; mapped_bytes=bytes; mapped_count=count;
+    }
+    std::string_view name(ProcId id) const {
+        if (id==IDLE_ID) return "IDLE";
+        if (id==MIGRATE_ID) return "MIGRATE";
+        if (id==SWITCH_ID) return "SWITCH";
+        if (mapped_index) return std::string_view(mapped_bytes+mapped_index[id], mapped_index[id+1]-mapped_index[id]);
+        return names[id];
+    }
+    size_t size() const { return mapped_index ? mapped_count : names.size(); }
+};
+
+// ---------- Metrics ----------
+// Sum/max reductions over the int32 result columns. On x86 the AVX2 versions are
+// compiled with a target attribute and chosen at runtime, so the binary still
+// runs (on the scalar loops) on CPUs without AVX2.
+struct ColumnSum { long long sum = 0; int max = INT_MIN; };
+
+static ColumnSum sumMaxScalar(const int32_t* v, size_t n) {
+    ColumnSum r;
+    for (size_t i = 0; i < n; ++i) { r.sum += v[i]; r.max = std::max(r.max, v[i]); }
+    return r;
+}
+// slowdown = turnaround / max(burst, 1)
+static void slowdownScalar(const int32_t* turn, const int32_t* burst, size_t n, double* out, double& sum) {
+    sum = 0;
+    for (size_t i = 0; i < n; ++i) { out[i] = (double)turn[i] / std::max(burst[i], 1); sum += out[i]; }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) static ColumnSum sumMaxAvx2(const int32_t* v, size_t n) {
+    __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256(), mx = _mm256_set1_epi32(INT_MIN);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        mx = _mm256_max_epi32(mx, x);
+        lo = _mm256_add_epi64(lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        hi = _mm256_add_epi64(hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    alignas(32) long long s[4]; alignas(32) int m[8];
+    _mm256_store_si256((__m256i*)s, _mm256_add_epi64(lo, hi));
+    _mm256_store_si256((__m256i*)m, mx);
+    ColumnSum r = sumMaxScalar(v + i, n - i);
+    r.sum += s[0] + s[1] + s[2] + s[3];
+    for (int k = 0; k < 8; ++k) r.max = std::max(r.max, m[k]);
+    return r;
+}
+__attribute__((target("avx2"))) static void slowdownAvx2(const int32_t* turn, const int32_t* burst, size_t n, double* out, double& sum) {
+    __m256d acc = _mm256_setzero_pd();
+    const __m128i one = _mm_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d t = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(turn + i)));
+        __m256d b = _mm256_cvtepi32_pd(_mm_max_epi32(_mm_loadu_si128((const __m128i*)(burst + i)), one));
+        __m256d q = _mm256_div_pd(t, b);
+        _mm256_storeu_pd(out + i, q);
+        acc = _mm256_add_pd(acc, q);
+    }
+    alignas(32) double a[4];
+    _mm256_store_pd(a, acc);
+    slowdownScalar(turn + i, burst + i, n - i, out + i, sum);
+    sum += a[0] + a[1] + a[2] + a[3];
+}
+static bool haveAvx2() { static const bool ok = __builtin_cpu_supports("avx2"); return ok; }
+#else
+static bool haveAvx2() { return false; }
+#endif
+
+static ColumnSum sumMax(const int32_t* v, size_t n) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (haveAvx2()) return sumMaxAvx2(v, n);
+#endif
+    return sumMaxScalar(v, n);
+}
+static void slowdowns(const int32_t* turn, const int32_t* burst, size_t n, double* out, double& sum) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (haveAvx2()) return slowdownAvx2(turn, burst, n, out, sum);
+#endif
+    slowdownScalar(turn, burst, n, out, sum);
+}
+
+struct Dist { double mean = 0, p50 = 0, p95 = 0, p99 = 0, max = 0; };
+struct Metrics {
+    Dist wait, turnaround, response, slowdown;
+    double cpu_util = 0, throughput = 0;
+    long long switches = 0; double switch_pct = 0;   // share of CPU time spent switching
+    double io_util = 0;
+};
+
+// Nearest-rank percentiles by successive nth_element calls, each on the part of
+// v above the previous rank (about 1.5 passes over v instead of a full sort).
+// Reorders v.
+template <class T> static void percentiles(std::vector<T>& v, Dist& d) {
+    size_t n = v.size(), lo = 0;
+    double* out[3] = { &d.p50, &d.p95, &d.p99 };
+    const double p[3] = { 0.50, 0.95, 0.99 };
+    for (int k = 0; k < 3; ++k) {
+        size_t rank = std::max<size_t>(1, (size_t)std::ceil(p[k] * n)) - 1;
+        std::nth_element(v.begin() + lo, v.begin() + rank, v.end());
+        *out[k] = v[rank]; lo = rank;
+    }
+}
+
+// cpus > 1: utilization is the share of cpus * total_time spent on jobs.
+Metrics calculateMetrics(const Workload& ps, const RunState& st, int total_time, int cpus = 1) {
+    Metrics m;
+    size_t n = ps.size();
+    if (n == 0) return m;
+    std::vector<int> scratch;
+    auto column = [&](const std::pmr::vector<int>& col, Dist& d) {
+        ColumnSum c = sumMax(col.data(), n);
+        d.mean = (double)c.sum / n; d.max = c.max;
+        scratch.assign(col.begin(), col.end());
+        percentiles(scratch, d);
+    };
+    column(st.waiting, m.wait);
+    column(st.turnaround, m.turnaround);
+    column(st.response, m.response);
+    std::vector<double> slow(n);
+    const int32_t* demand = ps.burst;   // with I/O, slowdown is over CPU + I/O time
+    std::vector<int32_t> service;
+    if (ps.io) {
+        service.resize(n);
+        for (size_t i = 0; i < n; ++i) service[i] = ps.burst[i] + ps.io[i];
+        demand = service.data();
+    }
+    slowdowns(st.turnaround.data(), demand, n, slow.data(), m.slowdown.mean);
+    m.slowdown.mean /= n;
+    m.slowdown.max = *std::max_element(slow.begin(), slow.end());
+    percentiles(slow, m.slowdown);
+    long long busy = sumMax(ps.burst, n).sum;
+    m.cpu_util = total_time ? (double)busy / ((double)total_time * cpus) * 100.0 : 0.0;
+    m.throughput = total_time ? (double)n / total_time : 0.0;
+    m.switches = st.switches;
+    m.switch_pct = total_time ? (double)st.switch_time / ((double)total_time * cpus) * 100.0 : 0.0;
+    m.io_util = total_time ? (double)st.io_busy / total_time * 100.0 : 0.0;
+    return m;
+}
+
+// Formats through a local buffer; a million blocks through operator<< took
+// longer than most schedulers take to produce them.
+// next(name, len) yields one block per call and returns false at the end.
+template <class Next>
+void writeGantt(std::ostream& out, Next next) {
+    std::vector<char> buf(1 << 16);
+    char* p = buf.data();
+    auto room = [&](size_t need){
+        if ((size_t)(buf.data() + buf.size() - p) < need) { out.write(buf.data(), p - buf.data()); p = buf.data(); }
+        if (buf.size() < need) { buf.resize(need); p = buf.data(); }
+    };
+    static const char head[] = "Gantt Chart: ";
+    room(sizeof head); memcpy(p, head, sizeof head - 1); p += sizeof head - 1;
+    std::string_view nm; int len;
+    while (next(nm, len)) {
+        room(nm.size() + 16);
+        *p++ = '('; memcpy(p, nm.data(), nm.size()); p += nm.size(); *p++ = ' ';
+        p = std::to_chars(p, buf.data() + buf.size(), len).ptr;
+        *p++ = ')'; *p++ = ' ';
+    }
+    room(1); *p++ = '\n';
+    out.write(buf.data(), p - buf.data());
+}
+
+void printGantt(const Gantt& gantt, const IdTable& ids) {
+    auto it = gantt.begin();
+    writeGantt(std::cout, [&](std::string_view& nm, int& len){
+        if (it == gantt.end()) return false;
+        nm = ids.name(it->first); len = it->second; ++it;
+        return true;
+    });
+}
+
+void printMetrics(const Workload& processes, const RunState& st, int total_time, int cpus = 1) {
+    Metrics m;
+    { SIM_PHASE(metrics); m = calculateMetrics(processes, st, total_time, cpus); }
+    std::cout << "Average Waiting Time: "  << m.wait.mean       << "\n";
+    std::cout << "Average Turnaround Time: " << m.turnaround.mean << "\n";
+    std::cout << "CPU Utilization: "       << m.cpu_util        << "%\n";
+    std::cout << "Throughput: "            << m.throughput      << " processes/unit time\n";
+    std::cout << "Average Response Time: " << m.response.mean   << "\n";
+    std::cout << "Average Slowdown: "      << m.slowdown.mean   << "\n";
+    std::cout << "Context Switches: "      << m.switches        << "\n";
+    std::cout << "Switch Overhead: "       << m.switch_pct      << "% of CPU time\n";
+    if (processes.io) std::cout << "I/O Utilization: " << m.io_util << "%\n";
+    auto tail = [](const char* label, const Dist& d) {
+        std::cout << label << " p50/p95/p99/max: " << d.p50 << " / " << d.p95 << " / " << d.p99 << " / " << d.max << "\n";
+    };
+    tail("Waiting Time", m.wait);
+    tail("Turnaround Time", m.turnaround);
+    tail("Response Time", m.response);
+    tail("Slowdown", m.slowdown);
 }
 
+void printResults(const Workload& processes, const RunState& st, int total_time,
+                  const Gantt& gantt, const IdTable& ids) {
+    if (gantt.stored()) printGantt(gantt, ids);
+    printMetrics(processes, st, total_time);
+}
+
+// --stats 1: the SIM_STATS counters for this run. "print" excludes the metrics
+// computed while printing.
+#ifdef SIM_STATS
+void printStats() {
+    const SimStats& s = g_sim_stats;
+    std::cout << "Decisions: "           << s.decisions   << "\n";
+    std::cout << "Queue Pushes/Pops: "   << s.pushes << " / " << s.pops << "\n";
+    std::cout << "Max Ready Queue: "     << s.max_ready   << "\n";
+    std::cout << "Preemptions: "         << s.preemptions << "\n";
+    std::cout << "Idle Jumps: "          << s.idle_jumps  << "\n";
+    std::cout << "Gantt Blocks: "        << s.blocks      << "\n";
+    std::cout << "Phase ms load/schedule/metrics/print: " << s.load_ms << " / " << s.schedule_ms << " / "
+              << s.metrics_ms << " / " << std::max(0.0, s.print_ms - s.metrics_ms) << "\n";
+    std::cout << "Heap Allocations load/schedule/metrics/print: " << s.load_allocs << " / " << s.schedule_allocs << " / "
+              << s.metrics_allocs << " / " << std::max(0LL, s.print_allocs - s.metrics_allocs) << "\n";
+}
+#else
+void printStats() {}
+#endif
+
+// Context-switch overhead. Dispatching a job other than the one the CPU last
+// ran costs `cost` units plus a cache warmup of min(warmup, units the job was
+// off the CPU); a job that never ran here, or last ran on another CPU, pays the
+// whole warmup. Zero by default.
+struct SwitchCost { int cost = 0, warmup = 0; };
+
 // ---------- Base ----------
 class Scheduler {
 public:
+    SwitchCost overhead;   // set by makeScheduler
     virtual ~Scheduler() = default;
-    virtual void schedule(std::vector<Process>& ps,
-                          std::vector<std::pair<std::string,int>>& gantt,
+    virtual void schedule(const Workload& ps, RunState& st,
+                          Gantt& gantt,
                           int& total_time) = 0;
+protected:
+    int dispatch(const Workload& ps, RunState& st, Gantt& gantt, int i, int t) const;
 };
 
 // Helpers
-static inline void finalizeBlock(const std::string& id, int start, int now,
-                                 std::vector<std::pair<std::string,int>>& gantt) {
-    if (start != -1 && !id.empty() && now > start) gantt.emplace_back(id, now - start);
+static inline void finalizeBlock(ProcId id, int start, int now, Gantt& gantt) {
+    if (start != -1 && id != NO_ID && now > start) gantt.emplace_back(id, now - start);
 }
-static inline bool anyLeft(const std::vector<Process>& ps) {
-    for (auto& p : ps) if (p.remaining_time > 0) return true;
+static inline bool anyLeft(const RunState& st) {
+    for (int r : st.remaining) if (r > 0) return true;
     return false;
 }
-static inline void initRemaining(std::vector<Process>& ps) {
-    for (auto& p : ps) p.remaining_time = p.burst_time;
+static inline void initRun(const Workload& ps, RunState& st) {
+    size_t n = ps.size();
+    st.remaining.resize(n); st.waiting.assign(n, 0); st.turnaround.assign(n, 0);
+    st.remaining.assign(ps.burst, ps.burst + n);
+    st.response.assign(n, -1);
+    st.cpu = CpuContext(); st.left.clear(); st.on.clear();
+    st.switches = st.switch_time = 0;
+    st.phase.clear(); st.io_busy = 0;
+    if (ps.seq_off) {   // run the first CPU burst; the rest come after I/O
+        st.phase.assign(n, 0);
+        for (size_t i = 0; i < n; ++i) st.remaining[i] = ps.seq[ps.seq_off[i]];
+    }
 }
+// Called when job i starts running at time t.
+static inline void onDispatch(const Workload& ps, RunState& st, int i, int t) {
+    if (st.response[i] < 0) st.response[i] = t - ps.arrival[i];
+}
+// Job i is picked on CPU c at time t: counts the switch and returns its
+// overhead (0 if i is what the CPU ran last). The caller puts a SWITCH block of
+// that length before i and starts i after it.
+static inline int switchTo(const SwitchCost& sc, RunState& st, CpuContext& ctx, int c, int i, int t) {
+    if (ctx.last == i) return 0;
+    int j = ctx.last; ctx.last = i;
+    ++st.switches;
+    if (sc.cost == 0 && sc.warmup == 0) return 0;
+    int over = sc.cost;
+    if (sc.warmup > 0) {
+        if (st.left.empty()) { st.left.assign(st.remaining.size(), -1); st.on.assign(st.remaining.size(), -1); }
+        if (j >= 0 && st.on[j] == c) st.left[j] = ctx.since + ctx.rem - st.remaining[j];
+        bool cold = st.left[i] < 0 || st.on[i] != c;
+        over += cold ? sc.warmup : std::min(sc.warmup, t - st.left[i]);
+        st.on[i] = c;
+        ctx.since = t + over; ctx.rem = st.remaining[i];
+    }
+    st.switch_time += over;
+    return over;
+}
+// Every scheduler calls this when it picks job i at time t, after closing the
+// previous Gantt block, and runs i from the returned time.
+inline int Scheduler::dispatch(const Workload& ps, RunState& st, Gantt& gantt, int i, int t) const {
+    SIM_STAT(decisions);
+    int over = switchTo(overhead, st, st.cpu, 0, i, t);
+    if (over > 0) { gantt.emplace_back(SWITCH_ID, over); t += over; }
+    onDispatch(ps, st, i, t);
+    return t;
+}
+static inline std::pmr::vector<int> arrivalOrder(const Workload& ps, std::pmr::memory_resource* mem) {
+    std::pmr::vector<int> ord(ps.size(), mem); std::iota(ord.begin(), ord.end(), 0);
+    // the loaders sort by arrival, and stable_sort would still take a scratch buffer from the heap
+    if (!std::is_sorted(ps.arrival, ps.arrival + ps.size()))
+        std::stable_sort(ord.begin(), ord.end(), [&](int a,int b){ return ps.arrival[a]<ps.arrival[b]; });
+    return ord;
+}
+
+// Jobs becoming ready, in time order: arrivals, and jobs coming back from I/O.
+// When a CPU burst ends and the job has more to do, it queues for the single
+// I/O device (FIFO) and is blocked until its I/O is done. Requests reach the
+// device in time order, so completion times never decrease and the blocked set
+// is a FIFO of wakeup timers. On a tie, arrivals come before wakeups.
+class JobEvents {
+    const Workload& ps; RunState& st;
+    std::pmr::vector<int> ord; size_t next = 0;
+    std::pmr::deque<std::pair<int,int>> blocked;   // (wakeup time, job)
+    int64_t io_free = 0;                      // when the device finishes its queue
+public:
+    JobEvents(const Workload& w, RunState& s) : ps(w), st(s), ord(arrivalOrder(w, s.mem)), blocked(s.mem) {}
+    // time of the next arrival or wakeup, INT_MAX if none is pending
+    int peek() const {
+        int a = next < ord.size() ? ps.arrival[ord[next]] : INT_MAX;
+        return blocked.empty() ? a : std::min(a, blocked.front().first);
+    }
+    int nextWakeup() const { return blocked.empty() ? INT_MAX : blocked.front().first; }
+    // the job behind peek()
+    int take() {
+        if (!blocked.empty() && (next == ord.size() || blocked.front().first < ps.arrival[ord[next]])) {
+            int j = blocked.front().second; blocked.pop_front(); return j;
+        }
+        return ord[next++];
+    }
+    bool wakeup(int i) const { return !st.phase.empty() && st.phase[i] > 0; }
+    // Job i's current CPU burst ended at t. Returns true if that was its last
+    // one (turnaround and waiting are then set); otherwise i is now blocked on
+    // I/O and st.remaining[i] is its next CPU burst.
+    bool burstDone(int i, int t) {
+        if (ps.seq_off) {
+            uint64_t k = ps.seq_off[i] + st.phase[i] + 1;   // the I/O burst after this one
+            if (k < ps.seq_off[i + 1]) {
+                io_free = std::max<int64_t>(io_free, t) + ps.seq[k];
+                st.io_busy += ps.seq[k];
+                blocked.push_back({(int)std::min<int64_t>(io_free, INT_MAX), i});
+                st.phase[i] += 2; st.remaining[i] = ps.seq[k + 1];
+                return false;
+            }
+        }
+        st.turnaround[i] = t - ps.arrival[i];
+        st.waiting[i] = st.turnaround[i] - ps.burst[i] - (ps.io ? ps.io[i] : 0);
+        return true;
+    }
+};
 
 // ---------- FCFS ----------
 class FCFSScheduler : public Scheduler {
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        std::sort(ps.begin(), ps.end(), [](auto& a, auto& b){ return a.arrival_time < b.arrival_time; });
-        int t = 0;
-        for (auto& p : ps) {
-            if (t < p.arrival_time) { gantt.emplace_back("IDLE", p.arrival_time - t); t = p.arrival_time; }
-            gantt.emplace_back(p.id, p.burst_time);
-            t += p.burst_time;
-            p.turnaround_time = t - p.arrival_time;
-            p.waiting_time = p.turnaround_time - p.burst_time;
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        int t = 0, n = (int)ps.size(), done = 0;
+        JobEvents ev(ps, st);
+        std::queue<int, std::pmr::deque<int>> q(std::pmr::deque<int>(st.mem));
+        auto admit = [&]{ while (ev.peek() <= t) { q.push(ev.take()); SIM_STAT(pushes); } };
+        while (done < n) {
+            admit();
+            if (q.empty()) { int na = ev.peek(); gantt.emplace_back(IDLE_ID, na - t); t = na; continue; }
+            int i = q.front(); q.pop(); SIM_STAT(pops);
+            t = dispatch(ps, st, gantt, i, t);
+            admit();
+            gantt.counter(CTR_READY, t, (long long)q.size());
+            gantt.emplace_back(ps.id[i], st.remaining[i]);
+            t += st.remaining[i];
+            st.remaining[i] = 0;
+            if (ev.burstDone(i, t)) ++done;
         }
         total_time = t;
     }
 };
 
-// ---------- SJF (non-preemptive) ----------
+// ---------- SJF (non-preemptive; with I/O, shortest next CPU burst) ----------
 class SJFScheduler : public Scheduler {
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        std::vector<int> ord(ps.size());
-        for (int i=0;i<(int)ord.size();++i) ord[i]=i;
-        std::sort(ord.begin(), ord.end(), [&](int a,int b){
-            if (ps[a].arrival_time!=ps[b].arrival_time) return ps[a].arrival_time<ps[b].arrival_time;
-            return ps[a].id<ps[b].id;
-        });
-        int t=0, next=0; std::vector<int> rq;
-        auto push=[&]{ while(next<(int)ord.size() && ps[ord[next]].arrival_time<=t) rq.push_back(ord[next++]); };
-        auto pick=[&]{ int b=-1; for(int i=0;i<(int)rq.size();++i)
-            if (b==-1 || ps[rq[i]].burst_time<ps[rq[b]].burst_time ||
-               (ps[rq[i]].burst_time==ps[rq[b]].burst_time && ps[rq[i]].id<ps[rq[b]].id)) b=i; return b; };
-        while(next<(int)ord.size() || !rq.empty()){
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        // top = shortest next burst, ties by id
+        auto cmp=[&](int a,int b){
+            if (st.remaining[a]!=st.remaining[b]) return st.remaining[a]>st.remaining[b];
+            return ps.id[a]>ps.id[b];
+        };
+        int n=(int)ps.size(), t=0, done=0;
+        std::pmr::vector<int> heap(st.mem); heap.reserve(n);
+        std::priority_queue<int, std::pmr::vector<int>, decltype(cmp)> rq(cmp, std::move(heap));
+        JobEvents ev(ps, st);
+        auto push=[&]{ while(ev.peek()<=t){ rq.push(ev.take()); SIM_STAT(pushes); } };
+        while(done<n){
             push();
-            if(rq.empty()){ int na=ps[ord[next]].arrival_time; gantt.emplace_back("IDLE",na-t); t=na; push(); }
-            int pos=pick(); int idx=rq[pos]; rq.erase(rq.begin()+pos);
-            gantt.emplace_back(ps[idx].id, ps[idx].burst_time);
-            t+=ps[idx].burst_time;
-            ps[idx].turnaround_time=t-ps[idx].arrival_time;
-            ps[idx].waiting_time=ps[idx].turnaround_time-ps[idx].burst_time;
+            if(rq.empty()){ int na=ev.peek(); gantt.emplace_back(IDLE_ID,na-t); t=na; push(); }
+            int idx=rq.top(); rq.pop(); SIM_STAT(pops); t=dispatch(ps, st, gantt, idx, t); gantt.counter(CTR_READY, t, (long long)rq.size());
+            gantt.emplace_back(ps.id[idx], st.remaining[idx]);
+            t+=st.remaining[idx]; st.remaining[idx]=0;
+            if(ev.burstDone(idx, t)) ++done;
         }
         total_time=t;
     }
 };
 
-// ---------- SRTF ----------
+// ---------- SRTF (event-driven: min-heap on remaining time, preempt only at arrivals) ----------
 class SRTFScheduler : public Scheduler {
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        int n=(int)ps.size(); std::vector<int> comp(n,-1);
-        int t=0; std::string last=""; int start=-1;
-        auto allDone=[&]{return !anyLeft(ps);};
-        while(!allDone()){
-            int best=-1;
-            for(int i=0;i<n;++i) if(ps[i].arrival_time<=t && ps[i].remaining_time>0){
-                if(best==-1 || ps[i].remaining_time<ps[best].remaining_time ||
-                  (ps[i].remaining_time==ps[best].remaining_time && ps[i].id<ps[best].id)) best=i;
-            }
-            if(best==-1){ // idle
-                int na=INT_MAX; for(int i=0;i<n;++i) if(ps[i].remaining_time>0) na=std::min(na, ps[i].arrival_time);
-                finalizeBlock(last,start,t,gantt); gantt.emplace_back("IDLE", na-t); t=na; continue;
-            }
-            if(last!=ps[best].id){ finalizeBlock(last,start,t,gantt); last=ps[best].id; start=t; }
-            ps[best].remaining_time--; t++;
-            if(ps[best].remaining_time==0) comp[best]=t;
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        int n=(int)ps.size();
+        JobEvents ev(ps, st);
+        // top = shortest remaining, ties by id (same rule as the old per-tick scan)
+        auto cmp=[&](int a,int b){
+            if(st.remaining[a]!=st.remaining[b]) return st.remaining[a]>st.remaining[b];
+            return ps.id[a]>ps.id[b];
+        };
+        std::pmr::vector<int> heap(st.mem); heap.reserve(n);
+        std::priority_queue<int, std::pmr::vector<int>, decltype(cmp)> rq(cmp, std::move(heap));
+        int t=0, done=0; ProcId last=NO_ID; int start=-1;
+        auto push=[&]{ while(ev.peek()<=t){ rq.push(ev.take()); SIM_STAT(pushes); } };
+        while(done<n){
+            push();
+            if(rq.empty()){ // idle until the next arrival or wakeup
+                int na=ev.peek();
+                finalizeBlock(last,start,t,gantt); last=NO_ID; start=-1;
+                gantt.emplace_back(IDLE_ID, na-t); t=na; continue;
+            }
+            int best=rq.top();
+            if(last!=ps.id[best]){
+                if(last!=NO_ID) SIM_STAT(preemptions); // the previous job is still queued
+                finalizeBlock(last,start,t,gantt); t=dispatch(ps, st, gantt, best, t); last=ps.id[best]; start=t; }
+            gantt.counter(CTR_READY, t, (long long)rq.size()-1);
+            // Between arrivals the running job only gets shorter, so nobody can overtake it:
+            // run straight to the end of its burst or the next arrival, whichever comes first.
+            // (An arrival during the switch is looked at before the job runs.)
+            int run=std::max(0, std::min(st.remaining[best], ev.peek()-t));
+            st.remaining[best]-=run; t+=run; // shrinking the top's key keeps the heap valid
+            if(st.remaining[best]==0){
+                rq.pop(); SIM_STAT(pops);
+                if(ev.burstDone(best, t)) ++done;
+                finalizeBlock(last,start,t,gantt); last=NO_ID; start=-1;
+            }
         }
         finalizeBlock(last,start,t,gantt);
-        for(int i=0;i<n;++i){ ps[i].turnaround_time=comp[i]-ps[i].arrival_time; ps[i].waiting_time=ps[i].turnaround_time-ps[i].burst_time; }
         total_time=t;
     }
 };
@@ -153,25 +831,24 @@ public:
 // ---------- Priority (non-preemptive, lower value = higher) ----------
 class PriorityScheduler : public Scheduler {
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        std::vector<int> ord(ps.size()); for(int i=0;i<(int)ord.size();++i) ord[i]=i;
-        std::sort(ord.begin(), ord.end(), [&](int a,int b){
-            if(ps[a].arrival_time!=ps[b].arrival_time) return ps[a].arrival_time<ps[b].arrival_time;
-            return ps[a].id<ps[b].id;
-        });
-        int t=0,next=0; std::vector<int> rq;
-        auto push=[&]{ while(next<(int)ord.size() && ps[ord[next]].arrival_time<=t) rq.push_back(ord[next++]); };
-        auto pick=[&]{ int b=0; for(int i=1;i<(int)rq.size();++i)
-            if(ps[rq[i]].priority<ps[rq[b]].priority ||
-              (ps[rq[i]].priority==ps[rq[b]].priority && ps[rq[i]].id<ps[rq[b]].id)) b=i; return b; };
-        while(next<(int)ord.size() || !rq.empty()){
-            push(); if(rq.empty()){ int na=ps[ord[next]].arrival_time; gantt.emplace_back("IDLE",na-t); t=na; push(); }
-            int pos=pick(); int idx=rq[pos]; rq.erase(rq.begin()+pos);
-            gantt.emplace_back(ps[idx].id, ps[idx].burst_time);
-            t+=ps[idx].burst_time;
-            ps[idx].turnaround_time=t-ps[idx].arrival_time;
-            ps[idx].waiting_time=ps[idx].turnaround_time-ps[idx].burst_time;
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        // top = lowest priority value, ties by id
+        auto cmp=[&](int a,int b){
+            if(ps.priority[a]!=ps.priority[b]) return ps.priority[a]>ps.priority[b];
+            return ps.id[a]>ps.id[b];
+        };
+        int n=(int)ps.size(), t=0, done=0;
+        std::pmr::vector<int> heap(st.mem); heap.reserve(n);
+        std::priority_queue<int, std::pmr::vector<int>, decltype(cmp)> rq(cmp, std::move(heap));
+        JobEvents ev(ps, st);
+        auto push=[&]{ while(ev.peek()<=t){ rq.push(ev.take()); SIM_STAT(pushes); } };
+        while(done<n){
+            push(); if(rq.empty()){ int na=ev.peek(); gantt.emplace_back(IDLE_ID,na-t); t=na; push(); }
+            int idx=rq.top(); rq.pop(); SIM_STAT(pops); t=dispatch(ps, st, gantt, idx, t); gantt.counter(CTR_READY, t, (long long)rq.size());
+            gantt.emplace_back(ps.id[idx], st.remaining[idx]);
+            t+=st.remaining[idx]; st.remaining[idx]=0;
+            if(ev.burstDone(idx, t)) ++done;
         }
         total_time=t;
     }
@@ -182,220 +859,1991 @@ class RoundRobinScheduler : public Scheduler {
     int quantum;
 public:
     explicit RoundRobinScheduler(int q):quantum(q){}
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        std::queue<Process*> q; int t=0; size_t idx=0;
-        int last_start=-1; std::string last="";
-        while(!q.empty() || idx<ps.size()){
-            while(idx<ps.size() && ps[idx].arrival_time<=t) q.push(&ps[idx++]);
-            if(q.empty()){ if(idx<ps.size()) t=ps[idx].arrival_time; continue; }
-            Process* cur=q.front(); q.pop();
-            int slice=std::min(quantum, cur->remaining_time);
-            if(last!=cur->id || last_start==-1){ finalizeBlock(last,last_start,t,gantt); last=cur->id; last_start=t; }
-            cur->remaining_time-=slice; t+=slice;
-            while(idx<ps.size() && ps[idx].arrival_time<=t) q.push(&ps[idx++]);
-            if(cur->remaining_time>0) q.push(cur);
-            else { cur->turnaround_time=t-cur->arrival_time; cur->waiting_time=cur->turnaround_time-cur->burst_time; }
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        std::queue<int, std::pmr::deque<int>> q(std::pmr::deque<int>(st.mem)); int t=0, n=(int)ps.size(), done=0;
+        JobEvents ev(ps, st);
+        int last_start=-1; ProcId last=NO_ID;
+        while(done<n){
+            while(ev.peek()<=t){ q.push(ev.take()); SIM_STAT(pushes); }
+            if(q.empty()){ // idle until the next arrival or wakeup
+                finalizeBlock(last,last_start,t,gantt); last=NO_ID; last_start=-1;
+                int na=ev.peek(); gantt.emplace_back(IDLE_ID, na-t); t=na; continue;
+            }
+            int cur=q.front(); q.pop(); SIM_STAT(pops);
+            int slice=std::min(quantum, st.remaining[cur]);
+            if(last!=ps.id[cur] || last_start==-1){ finalizeBlock(last,last_start,t,gantt); t=dispatch(ps, st, gantt, cur, t); last=ps.id[cur]; last_start=t; }
+            gantt.counter(CTR_READY, t, (long long)q.size());
+            st.remaining[cur]-=slice; t+=slice;
+            while(ev.peek()<=t){ q.push(ev.take()); SIM_STAT(pushes); }
+            if(st.remaining[cur]>0){ q.push(cur); SIM_STAT(pushes); SIM_STAT(preemptions); }
+            else if(ev.burstDone(cur, t)) ++done;
         }
         finalizeBlock(last,last_start,t,gantt);
         total_time=t;
     }
 };
 
-// ---------- MLQ (2 queues: high RR q=4 if priority<3, low FCFS) ----------
+// ---------- MLQ (N fixed classes by priority, each with its own policy; default high RR q=4 if priority<3, low FCFS) ----------
+// Classes are strictly ordered: class k runs only while classes <k are empty, and is
+// preempted only when a job of a lower-numbered class arrives. That arrival is read
+// off the per-class arrival streams, so a batch job runs in one step, not per tick.
+// A preempted job goes back to the tail of its class (by key for sjf/prio).
+// With I/O, a wakeup into a higher class preempts the same way.
+struct MLQClass {
+    enum Policy { FCFS, SJF, PRIO, RR } policy = FCFS;
+    int quantum = 0;       // RR only
+    int below = INT_MAX;   // jobs with priority < below land here (first match wins)
+};
+
 class MLQScheduler : public Scheduler {
+    std::vector<MLQClass> classes;
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        std::queue<Process*> high, low; int t=0; size_t idx=0; int q=4;
-        auto push=[&]{ while(idx<ps.size() && ps[idx].arrival_time<=t){
-                (ps[idx].priority<3?high:low).push(&ps[idx]); ++idx; } };
-        while(anyLeft(ps)){
-            push();
-            if(!high.empty()){
-                Process* p=high.front(); high.pop(); int slice=std::min(q,p->remaining_time);
-                gantt.emplace_back(p->id,slice); t+=slice; p->remaining_time-=slice; push();
-                if(p->remaining_time>0) high.push(p);
-                else { p->turnaround_time=t-p->arrival_time; p->waiting_time=p->turnaround_time-p->burst_time; }
-                continue;
+    explicit MLQScheduler(std::vector<MLQClass> cls):classes(std::move(cls)){
+        if(classes.empty()) classes.push_back(MLQClass());
+        classes.back().below=INT_MAX; // last class takes everything else
+    }
+    explicit MLQScheduler(int quantum=4, int split_priority=3)
+        :MLQScheduler(std::vector<MLQClass>{{MLQClass::RR,quantum,split_priority},{MLQClass::FCFS,0,INT_MAX}}){}
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        int n=(int)ps.size(), K=(int)classes.size();
+        std::pmr::vector<int> ord = arrivalOrder(ps, st.mem), cls(n, st.mem);
+        std::pmr::vector<std::pmr::vector<int>> stream(K, st.mem); // per-class arrivals, in arrival order
+        for(int i:ord){
+            int k=0; while(ps.priority[i]>=classes[k].below) ++k;
+            cls[i]=k; stream[k].push_back(i);
+        }
+        // (key, tie, job): fcfs/rr key on enqueue order, sjf on remaining, prio on priority
+        using Entry = std::tuple<long long,long long,int>;
+        using ClassQueue = std::priority_queue<Entry,std::pmr::vector<Entry>,std::greater<Entry>>;
+        std::pmr::vector<ClassQueue> ready(st.mem);
+        for(int k=0;k<K;++k) ready.emplace_back(std::greater<Entry>(), std::pmr::vector<Entry>(st.mem));
+        std::pmr::vector<size_t> seen(K,0,st.mem);
+        long long seq=0; int t=0, done=0, ready_n=0;
+        JobEvents ev(ps, st);
+        auto enq=[&](int i){
+            SIM_STAT(pushes);
+            const MLQClass& c=classes[cls[i]];
+            if(c.policy==MLQClass::SJF) ready[cls[i]].push({st.remaining[i],ps.id[i],i});
+            else if(c.policy==MLQClass::PRIO) ready[cls[i]].push({ps.priority[i],ps.id[i],i});
+            else ready[cls[i]].push({0,seq++,i});
+        };
+        auto admit=[&]{
+            while(ev.peek()<=t){
+                int i=ev.take();
+                if(!ev.wakeup(i)) ++seen[cls[i]];
+                enq(i); ++ready_n;
             }
-            if(!low.empty()){
-                Process* p=low.front(); low.pop(); int ran=0;
-                while(p->remaining_time>0){ push(); if(!high.empty()) break; p->remaining_time--; t++; ran++; push(); }
-                if(ran>0) gantt.emplace_back(p->id,ran);
-                if(p->remaining_time==0){ p->turnaround_time=t-p->arrival_time; p->waiting_time=p->turnaround_time-p->burst_time; }
-                else low.push(p);
-                continue;
+        };
+        auto higherArrival=[&](int k){ // next arrival that would preempt class k
+            int h=INT_MAX;
+            for(int j=0;j<k;++j) if(seen[j]<stream[j].size()) h=std::min(h, ps.arrival[stream[j][seen[j]]]);
+            return h;
+        };
+        auto higherReady=[&](int k){ for(int j=0;j<k;++j) if(!ready[j].empty()) return true; return false; };
+        admit();
+        while(done<n){
+            int k=0; while(k<K && ready[k].empty()) ++k;
+            if(k==K){ int na=ev.peek(); gantt.emplace_back(IDLE_ID,na-t); t=na; admit(); continue; }
+            int p=std::get<2>(ready[k].top()); ready[k].pop(); SIM_STAT(pops); --ready_n; t=dispatch(ps, st, gantt, p, t);
+            gantt.counter(CTR_READY, t, ready_n);
+            int slice=st.remaining[p];
+            if(classes[k].policy==MLQClass::RR) slice=std::min(slice, classes[k].quantum);
+            // run to the end of the slice or until a higher class has work; any
+            // wakeup is a stop (it may be into a higher class)
+            int run=0;
+            while(true){
+                int h=std::min(higherArrival(k), ev.nextWakeup());
+                int step=std::max(0, std::min(slice-run, h-t)); // 0: preempted during the switch
+                run+=step; t+=step;
+                if(run==slice) break;
+                admit();
+                if(higherReady(k)) break;
             }
-            if(idx<ps.size()){ int na=ps[idx].arrival_time; gantt.emplace_back("IDLE",na-t); t=na; }
+            if(run>0) gantt.emplace_back(ps.id[p],run);
+            st.remaining[p]-=run; admit();
+            if(st.remaining[p]>0){ enq(p); ++ready_n; SIM_STAT(preemptions); }
+            else if(ev.burstDone(p, t)) ++done;
         }
         total_time=t;
     }
 };
 
-// ---------- MLFQ (3 queues RR with quanta 2,4,8; demote on full slice; simple aging) ----------
+// Parses "3:rr/4,6:sjf,fcfs": one class per comma, "[below:]policy" with policy
+// fcfs, sjf, prio or rr/Q. The last class catches every remaining priority.
+bool parseMlqClasses(const std::string& spec, std::vector<MLQClass>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t comma = spec.find(',', pos);
+        if (comma == std::string::npos) comma = spec.size();
+        std::string item = spec.substr(pos, comma - pos);
+        MLQClass c;
+        size_t colon = item.find(':');
+        if (colon != std::string::npos) {
+            const char* b = item.data(); const char* e = b + colon;
+            if (std::from_chars(b, e, c.below).ptr != e || colon == 0) return false;
+            item = item.substr(colon + 1);
+        }
+        if (item == "fcfs") c.policy = MLQClass::FCFS;
+        else if (item == "sjf") c.policy = MLQClass::SJF;
+        else if (item == "prio") c.policy = MLQClass::PRIO;
+        else if (item.rfind("rr/", 0) == 0) {
+            c.policy = MLQClass::RR;
+            const char* b = item.data() + 3; const char* e = item.data() + item.size();
+            if (std::from_chars(b, e, c.quantum).ptr != e || b == e || c.quantum < 1) return false;
+        } else return false;
+        out.push_back(c);
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+// ---------- MLFQ (event-driven; RR per level, demote on full slice, aging timers, optional boost) ----------
+// Level k runs RR with quanta[k] (default 2,4,8). A job that uses its whole slice
+// drops a level; a job that has waited `age` units below level 0 is promoted one
+// level by a timer event; every `boost` units (0 = off) all jobs go back to level
+// 0. The running job is preempted as soon as a higher level has work. A job that
+// blocks on I/O before its slice is up keeps its level. The loop only stops at
+// arrivals, wakeups, slice ends, burst ends and timer/boost events.
 class MLFQScheduler : public Scheduler {
+    std::vector<int> quanta; int AGE, boost;
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        std::queue<Process*> q[3]; int quantum[3]={2,4,8}; int t=0; size_t idx=0; const int AGE=10;
-        std::vector<int> last_enq(ps.size(),0), level(ps.size(),0);
-        auto enq=[&](int i,int lv){ level[i]=std::max(0,std::min(2,lv)); q[level[i]].push(&ps[i]); last_enq[i]=t; };
-        auto push=[&]{ while(idx<ps.size() && ps[idx].arrival_time<=t){ enq((int)idx,0); ++idx; } };
-        std::vector<int> comp(ps.size(),-1);
-        while(anyLeft(ps)){
-            push(); int qi=-1; for(int i=0;i<3;++i) if(!q[i].empty()){qi=i; break;}
-            if(qi==-1){ if(idx<ps.size()){int na=ps[idx].arrival_time; gantt.emplace_back("IDLE",na-t); t=na;} continue; }
-            Process* p=q[qi].front(); q[qi].pop(); int id=(int)(p-&ps[0]);
-            if(qi>0 && t-last_enq[id]>=AGE){ enq(id,qi-1); continue; }
-            int ran=0; while(ran<quantum[qi] && p->remaining_time>0){
-                p->remaining_time--; t++; ran++; push(); if(qi>0 && !q[0].empty()) break;
+    explicit MLFQScheduler(std::vector<int> level_quanta = {2,4,8}, int age=10, int boost_period=0)
+        :quanta(std::move(level_quanta)),AGE(age),boost(boost_period){ if(quanta.empty()) quanta={2}; }
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        int n=(int)ps.size(), L=(int)quanta.size();
+        // queue entries and timers carry the job's stamp at enqueue time; any later
+        // enqueue or dispatch bumps the stamp, which cancels them lazily
+        using Entry = std::pair<int,uint32_t>;
+        std::pmr::vector<std::queue<Entry, std::pmr::deque<Entry>>> q(st.mem);
+        for(int k=0;k<L;++k) q.emplace_back(std::pmr::deque<Entry>(st.mem));
+        std::pmr::vector<int> level(n,0,st.mem); std::pmr::vector<uint32_t> stamp(n,0,st.mem);
+        using Timer = std::tuple<int,int,uint32_t>; // (fire time, job, stamp)
+        std::priority_queue<Timer, std::pmr::vector<Timer>, std::greater<Timer>> timers(std::greater<Timer>(), std::pmr::vector<Timer>(st.mem));
+        int t=0, done=0, ready_n=0, next_boost=boost, epoch=0; bool boosted=false;
+        JobEvents ev(ps, st);
+        std::pmr::vector<int> blocked_epoch(n,0,st.mem); // a boost while a job is blocked on I/O also resets it
+        auto enq=[&](int i,int lv){
+            level[i]=lv; ++stamp[i]; q[lv].push({i,stamp[i]}); SIM_STAT(pushes);
+            if(lv>0) timers.push({t+AGE,i,stamp[i]});
+        };
+        auto top=[&]{
+            for(int k=0;k<L;++k){
+                while(!q[k].empty() && stamp[q[k].front().first]!=q[k].front().second) q[k].pop();
+                if(!q[k].empty()) return k;
             }
-            if(ran>0) gantt.emplace_back(p->id,ran);
-            if(p->remaining_time==0) comp[id]=t;
-            else enq(id, (ran==quantum[qi] && qi<2)? qi+1 : qi);
-        }
-        for(size_t i=0;i<ps.size();++i){ ps[i].turnaround_time=comp[i]-ps[i].arrival_time; ps[i].waiting_time=ps[i].turnaround_time-ps[i].burst_time; }
-        // compute total_time as the max (arrival_time + turnaround_time) across processes
-        total_time = 0;
-        for (const auto& p : ps) {
-            total_time = std::max(total_time, p.arrival_time + p.turnaround_time);
+            return -1;
+        };
+        auto events=[&]{
+            while(ev.peek()<=t){
+                int i=ev.take(); ++ready_n;
+                enq(i, ev.wakeup(i) && blocked_epoch[i]==epoch ? level[i] : 0);
+            }
+            while(!timers.empty() && std::get<0>(timers.top())<=t){
+                auto [when,i,sp]=timers.top(); timers.pop();
+                if(stamp[i]==sp) enq(i, level[i]-1); // waited AGE units: promote
+            }
+            if(boost>0 && t>=next_boost){
+                for(int k=1;k<L;++k) while(!q[k].empty()){ auto [i,sp]=q[k].front(); q[k].pop(); if(stamp[i]==sp) enq(i,0); }
+                next_boost=(t/boost+1)*boost; boosted=true; ++epoch;
+            }
+        };
+        auto nextEvent=[&]{
+            int e=ev.peek();
+            if(!timers.empty()) e=std::min(e, std::get<0>(timers.top()));
+            if(boost>0) e=std::min(e, next_boost);
+            return e;
+        };
+        events();
+        while(done<n){
+            int lv=top();
+            if(lv<0){ int na=ev.peek(); gantt.emplace_back(IDLE_ID,na-t); t=na; events(); continue; }
+            int cur=q[lv].front().first; q[lv].pop(); SIM_STAT(pops); ++stamp[cur]; --ready_n; // cancels its aging timer
+            boosted=false; // before the switch: a boost during it must still reach this job
+            int t0=t; t=dispatch(ps, st, gantt, cur, t);
+            if(t>t0) events(); // what came due during the switch waits for the next check
+            if(boosted) lv=0; // a boost during the switch: the job starts at level 0
+            gantt.counter(CTR_READY, t, ready_n); gantt.counter(CTR_MLFQ_LEVEL, t, lv);
+            int slice=quanta[lv], ran=0;
+            while(true){
+                int run=std::min({slice-ran, st.remaining[cur], nextEvent()-t});
+                st.remaining[cur]-=run; t+=run; ran+=run;
+                events();
+                if(st.remaining[cur]==0 || ran==slice) break;
+                if(lv>0 && boosted) break;
+                if(lv>0){ int hi=top(); if(hi>=0 && hi<lv) break; } // preempted by a higher level
+            }
+            gantt.emplace_back(ps.id[cur],ran);
+            if(st.remaining[cur]==0){
+                if(ev.burstDone(cur, t)) ++done;
+                else blocked_epoch[cur]=epoch; // gave up the CPU for I/O: keeps its level
+            }
+            else if(boosted){ enq(cur,0); ++ready_n; SIM_STAT(preemptions); }
+            else { enq(cur, (ran==slice && lv<L-1)? lv+1 : lv); ++ready_n; SIM_STAT(preemptions); }
         }
+        total_time=t;
+    }
+};
+
+// ---------- Lottery (tickets scale/priority; RR quantum=4; probabilistic pick) ----------
+// Fenwick tree over per-process ticket counts. Arrivals, completions and ticket
+// changes are point updates and a draw is a prefix-sum descent, all O(log n),
+// so the cost no longer depends on how many tickets are in play.
+// Compensation tickets only exist with I/O: without it a slice is cut short
+// only by the job finishing, so no job ever leaves the CPU early and returns.
+class TicketTree {
+    std::pmr::vector<long long> tree, val; long long sum = 0; int top = 1;
+public:
+    TicketTree(int n, std::pmr::memory_resource* mem) : tree(n+1,0,mem), val(n,0,mem) { while(top*2<=n) top*=2; }
+    void set(int i, long long tickets) {
+        long long d=tickets-val[i]; val[i]=tickets; sum+=d;
+        for(int k=i+1;k<(int)tree.size();k+=k&-k) tree[k]+=d;
+    }
+    long long get(int i) const { return val[i]; }
+    long long total() const { return sum; }
+    // index owning ticket number `ticket` (0-based, < total())
+    int find(long long ticket) const {
+        int pos=0;
+        for(int step=top;step>0;step>>=1)
+            if(pos+step<(int)tree.size() && tree[pos+step]<=ticket){ pos+=step; ticket-=tree[pos]; }
+        return pos;
     }
 };
 
-// ---------- Lottery (tickets 10/priority; RR quantum=4; probabilistic pick) ----------
 class LotteryScheduler : public Scheduler {
+    long long scale; uint64_t seed;
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        std::vector<int> tickets(ps.size());
-        for (size_t i=0;i<ps.size();++i){ int pr=std::max(1, ps[i].priority); tickets[i]=std::max(1,10/pr); }
-        std::mt19937 gen((unsigned)std::chrono::system_clock::now().time_since_epoch().count());
-        int t=0, q=4; size_t idx=0;
-        auto pushTo=[&](int tt){ if(tt>t){ gantt.emplace_back("IDLE",tt-t); t=tt; } };
-        while(anyLeft(ps)){
-            while(idx<ps.size() && ps[idx].arrival_time<=t) ++idx;
-            std::vector<int> bag;
-            for(size_t i=0;i<ps.size();++i)
-                if(ps[i].remaining_time>0 && ps[i].arrival_time<=t) bag.insert(bag.end(), tickets[i], (int)i);
-            if(bag.empty()){ if(idx<ps.size()) pushTo(ps[idx].arrival_time); continue; }
-            std::uniform_int_distribution<> dist(0,(int)bag.size()-1);
-            int i = bag[dist(gen)];
-            int slice=std::min(q, ps[i].remaining_time);
-            gantt.emplace_back(ps[i].id, slice); ps[i].remaining_time-=slice; t+=slice;
-            if(ps[i].remaining_time==0){ ps[i].turnaround_time=t-ps[i].arrival_time; ps[i].waiting_time=ps[i].turnaround_time-ps[i].burst_time; }
+    static constexpr int QUANTUM = 4;
+    // Largest --tickets for n jobs: a job holds at most scale*QUANTUM tickets
+    // (with compensation), so the tree's total stays within int64.
+    static long long maxScale(size_t n) { return INT64_MAX / (long long)std::max<size_t>(n, 1) / QUANTUM; }
+    explicit LotteryScheduler(long long ticket_scale=10, uint64_t draw_seed=1):scale(ticket_scale),seed(draw_seed){}
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        int n=(int)ps.size();
+        std::pmr::vector<long long> tickets(n, st.mem);
+        for (int i=0;i<n;++i){ int pr=std::max(1, ps.priority[i]); tickets[i]=std::max(1LL,scale/pr); }
+        std::pmr::vector<long long> on_wake(tickets, st.mem);   // tickets a job holds when it becomes ready
+        JobEvents ev(ps, st);
+        std::mt19937_64 gen(seed);   // same seed, same draws: every run of a config is reproducible
+        TicketTree ready(n, st.mem);
+        int t=0, q=QUANTUM, done=0, ready_n=0;
+        auto push=[&]{ while(ev.peek()<=t){ int j=ev.take(); ready.set(j,on_wake[j]); ++ready_n; SIM_STAT(pushes); } };
+        while(done<n){
+            push();
+            long long total=ready.total();
+            if(total==0){ int na=ev.peek(); gantt.emplace_back(IDLE_ID,na-t); t=na; continue; }
+            std::uniform_int_distribution<long long> dist(0,total-1);
+            int i = ready.find(dist(gen)); t=dispatch(ps, st, gantt, i, t); gantt.counter(CTR_READY, t, ready_n-1);
+            int slice=std::min(q, st.remaining[i]);
+            gantt.emplace_back(ps.id[i], slice); st.remaining[i]-=slice; t+=slice;
+            if(st.remaining[i]==0){
+                ready.set(i,0); --ready_n; SIM_STAT(pops);
+                if(ev.burstDone(i, t)) ++done;
+                // compensation tickets: a job that blocked after part of its quantum
+                // comes back with its tickets inflated by q/slice until it runs again
+                else on_wake[i] = slice>0 && slice<q ? tickets[i]*q/slice : tickets[i];
+            }
+            else {
+                SIM_STAT(preemptions);
+                if(ready.get(i)!=tickets[i]) ready.set(i, tickets[i]);
+            }
         }
         total_time=t;
     }
 };
 
-// ---------- CFS (simplified) ----------
+// ---------- CFS (rb-tree runqueue keyed on vruntime, Linux nice->weight, min_vruntime placement) ----------
+// nice = priority clamped to [-20,19]. vruntime is fixed-point (nice-0 time << 10)
+// and advances by delta*1024/weight. Each dispatch gets period*w/total_w, where
+// period = max(latency, nr_running*granularity), floored at one unit. New tasks start
+// at min_vruntime + their vslice (START_DEBIT) and preempt the current task on arrival
+// only if it is ahead by more than one granularity of the new task's vruntime; the
+// running task's slice is also recomputed when the runqueue grows (check_preempt_tick).
+// A task waking from I/O keeps its vruntime, but no less than min_vruntime minus
+// half the latency (GENTLE_FAIR_SLEEPERS), and gets the same preemption check.
 class CFSScheduler : public Scheduler {
+    int latency, granularity;
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps); for(auto& p: ps) p.vruntime=0.0;
-        auto cmp=[](const Process* a,const Process* b){ return a->vruntime > b->vruntime; };
-        std::priority_queue<Process*, std::vector<Process*>, decltype(cmp)> rq(cmp);
-        int t=0; size_t idx=0; int base_slice=2; std::vector<int> comp(ps.size(),-1);
-        auto push=[&]{ while(idx<ps.size() && ps[idx].arrival_time<=t) rq.push(&ps[idx++]); };
-        auto weight=[&](const Process& p){ int pr=std::max(1,p.priority); return 1.0/pr; };
-        while(anyLeft(ps)){
-            push(); if(rq.empty()){ if(idx<ps.size()){ int na=ps[idx].arrival_time; gantt.emplace_back("IDLE",na-t); t=na; } continue; }
-            Process* p=rq.top(); rq.pop(); int id=(int)(p-&ps[0]);
-            int slice=std::min(base_slice, p->remaining_time);
-            gantt.emplace_back(p->id,slice); p->remaining_time-=slice; t+=slice;
-            double w=weight(*p); if(w<=0) w=1.0; p->vruntime += slice / w;
-            push();
-            if(p->remaining_time==0) comp[id]=t; else rq.push(p);
+    static constexpr int NICE_0_LOAD = 1024;
+    static constexpr int VSHIFT = 10;
+    static int weightOf(int priority) {
+        static const int prio_to_weight[40] = {
+         /* -20 */ 88761, 71755, 56483, 46273, 36291,
+         /* -15 */ 29154, 23254, 18705, 14949, 11916,
+         /* -10 */  9548,  7620,  6100,  4904,  3906,
+         /*  -5 */  3121,  2501,  1991,  1586,  1277,
+         /*   0 */  1024,   820,   655,   526,   423,
+         /*   5 */   335,   272,   215,   172,   137,
+         /*  10 */   110,    87,    70,    56,    45,
+         /*  15 */    36,    29,    23,    18,    15,
+        };
+        return prio_to_weight[std::clamp(priority, -20, 19) + 20];
+    }
+    static int64_t calcDeltaFair(int64_t delta, int weight) { return (delta << VSHIFT) * NICE_0_LOAD / weight; }
+    explicit CFSScheduler(int latency_units=16, int granularity_units=2):latency(latency_units),granularity(granularity_units){}
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        int n=(int)ps.size();
+        std::pmr::vector<int> w(n, st.mem);
+        std::pmr::vector<int64_t> vruntime(n,0,st.mem);
+        for(int i=0;i<n;++i) w[i]=weightOf(ps.priority[i]);
+        std::pmr::set<std::pair<int64_t,int>> rq(st.mem); // (vruntime, job); begin() is the leftmost task
+        int64_t min_vruntime=0, total_w=0, nr_running=0;
+        const int64_t sleeper_credit=((int64_t)latency<<VSHIFT)/2;
+        int t=0, done=0, curr=-1;
+        JobEvents ev(ps, st);
+        auto slice=[&](int i){ // sched_slice: the task's share of the period
+            int64_t period=std::max<int64_t>(latency, nr_running*granularity);
+            return (int)std::max<int64_t>(1, std::min<int64_t>(INT_MAX, period*w[i]/total_w));
+        };
+        auto updateMinVruntime=[&]{
+            int64_t v = curr>=0 ? vruntime[curr] : INT64_MAX;
+            if(!rq.empty()) v=std::min(v, rq.begin()->first);
+            if(v!=INT64_MAX) min_vruntime=std::max(min_vruntime, v);
+        };
+        bool preempt=false;
+        auto admit=[&]{
+            while(ev.peek()<=t){
+                int i=ev.take();
+                ++nr_running; total_w+=w[i];
+                if(ev.wakeup(i)) vruntime[i]=std::max(vruntime[i], min_vruntime-sleeper_credit);
+                else vruntime[i]=min_vruntime + calcDeltaFair(slice(i), w[i]); // START_DEBIT
+                rq.insert({vruntime[i],i}); SIM_STAT(pushes);
+                if(curr>=0 && vruntime[curr]-vruntime[i] > calcDeltaFair(granularity, w[i])) preempt=true;
+            }
+        };
+        admit();
+        while(done<n){
+            if(rq.empty()){ int na=ev.peek(); gantt.emplace_back(IDLE_ID,na-t); t=na; admit(); continue; }
+            auto node=rq.extract(rq.begin()); curr=node.value().second; SIM_STAT(pops); // requeued below without a new node
+            int t0=t; t=dispatch(ps, st, gantt, curr, t);
+            if(t>t0) admit(); // arrivals during the switch only shorten the slice (preempt is cleared below)
+            gantt.counter(CTR_READY, t, (long long)rq.size());
+            int ideal=slice(curr), ran=0; preempt=false;
+            while(true){
+                int step=std::min({ideal-ran, st.remaining[curr], ev.peek()-t});
+                st.remaining[curr]-=step; t+=step; ran+=step;
+                vruntime[curr]+=calcDeltaFair(step, w[curr]);
+                updateMinVruntime();
+                if(st.remaining[curr]==0 || ran==ideal) break;
+                admit(); // wakeup preemption check; a longer runqueue also shrinks our slice
+                ideal=slice(curr);
+                if(preempt || ran>=ideal) break;
+            }
+            gantt.emplace_back(ps.id[curr],ran);
+            if(st.remaining[curr]==0){ // done, or dequeued while it waits for I/O
+                if(ev.burstDone(curr, t)) ++done;
+                --nr_running; total_w-=w[curr];
+            }
+            else { node.value().first=vruntime[curr]; rq.insert(std::move(node)); SIM_STAT(pushes); SIM_STAT(preemptions); }
+            curr=-1; updateMinVruntime();
+            admit();
         }
-        for(size_t i=0;i<ps.size();++i){ ps[i].turnaround_time=comp[i]-ps[i].arrival_time; ps[i].waiting_time=ps[i].turnaround_time-ps[i].burst_time; }
         total_time=t;
     }
 };
 
-// ---------- EDF (preemptive; if deadline==0 set arrival+2*burst) ----------
+// ---------- EDF (preemptive, event-driven; if deadline==0 set arrival+2*(burst+io)) ----------
 class EDFScheduler : public Scheduler {
 public:
-    void schedule(std::vector<Process>& ps, std::vector<std::pair<std::string,int>>& gantt, int& total_time) override {
-        initRemaining(ps);
-        for(auto& p: ps) if(p.deadline==0) p.deadline = p.arrival_time + 2*p.burst_time;
-        auto cmp=[](const Process* a,const Process* b){ return a->deadline > b->deadline; };
-        std::priority_queue<Process*, std::vector<Process*>, decltype(cmp)> rq(cmp);
-        int t=0; size_t idx=0; std::vector<int> comp(ps.size(),-1);
-        std::string last=""; int start=-1;
-        auto push=[&]{ while(idx<ps.size() && ps[idx].arrival_time<=t) rq.push(&ps[idx++]); };
-        auto flush=[&]{ finalizeBlock(last,start,t,gantt); last=""; start=-1; };
-        while(anyLeft(ps)){
+    void schedule(const Workload& ps, RunState& st, Gantt& gantt, int& total_time) override {
+        initRun(ps, st);
+        int n=(int)ps.size(); std::pmr::vector<int> dl(n, st.mem);
+        for(int i=0;i<n;++i) dl[i] = ps.deadline[i] ? ps.deadline[i] : ps.arrival[i] + 2*(ps.burst[i] + (ps.io ? ps.io[i] : 0));
+        JobEvents ev(ps, st);
+        auto cmp=[&](int a,int b){
+            if(dl[a]!=dl[b]) return dl[a]>dl[b];
+            return ps.id[a]>ps.id[b];
+        };
+        std::pmr::vector<int> heap(st.mem); heap.reserve(n);
+        std::priority_queue<int, std::pmr::vector<int>, decltype(cmp)> rq(cmp, std::move(heap));
+        int t=0, done=0; ProcId last=NO_ID; int start=-1;
+        auto push=[&]{ while(ev.peek()<=t){ rq.push(ev.take()); SIM_STAT(pushes); } };
+        auto flush=[&]{ finalizeBlock(last,start,t,gantt); last=NO_ID; start=-1; };
+        while(done<n){
             push();
-            if(rq.empty()){ if(idx<ps.size()){ flush(); gantt.emplace_back("IDLE", ps[idx].arrival_time - t); t = ps[idx].arrival_time; } continue; }
-            Process* p=rq.top(); rq.pop();
-            if(last!=p->id){ flush(); last=p->id; start=t; }
-            p->remaining_time--; t++; push();
-            if(p->remaining_time==0) comp[(int)(p-&ps[0])]=t; else rq.push(p);
+            if(rq.empty()){ int na=ev.peek(); flush(); gantt.emplace_back(IDLE_ID, na-t); t=na; continue; }
+            int cur=rq.top();
+            if(last!=ps.id[cur]){
+                if(last!=NO_ID) SIM_STAT(preemptions); // the previous job is still queued
+                flush(); t=dispatch(ps, st, gantt, cur, t); last=ps.id[cur]; start=t; }
+            gantt.counter(CTR_READY, t, (long long)rq.size()-1);
+            // Deadlines are fixed, so only an arrival or wakeup can change the heap
+            // top: run to the end of the burst or the next one, then re-check.
+            int run=std::max(0, std::min(st.remaining[cur], ev.peek()-t));
+            st.remaining[cur]-=run; t+=run;
+            if(st.remaining[cur]==0){
+                rq.pop(); SIM_STAT(pops);
+                if(ev.burstDone(cur, t)) ++done;
+                flush();
+            }
         }
-        finalizeBlock(last,start,t,gantt);
-        for(size_t i=0;i<ps.size();++i){ ps[i].turnaround_time=comp[i]-ps[i].arrival_time; ps[i].waiting_time=ps[i].turnaround_time-ps[i].burst_time; }
+        flush();
         total_time=t;
     }
 };
 
 // ---------- IO & Input ----------
-std::vector<Process> loadProcesses(const std::string& filename) {
-    std::vector<Process> ps; std::ifstream f(filename);
-    if(!f){ std::cerr<<"Error opening file: "<<filename<<"\n"; return ps; }
-    std::string id; int at, bt, pri, dl;
-    while(true){
-        if(!(f>>id>>at>>bt>>pri)) break;
-        if(f.peek()==' '||f.peek()=='\t'){ if(f>>dl) ps.push_back({id,at,bt,pri,0,0,0,dl}); else ps.push_back({id,at,bt,pri}); }
-        else ps.push_back({id,at,bt,pri});
-    }
-    std::sort(ps.begin(), ps.end(), [](auto&a,auto&b){return a.arrival_time<b.arrival_time;});
+// Parses the text workload format straight out of an mmap'd file with
+// std::from_chars (no iostreams, no per-field allocation). Each line is
+// `ID arrival burst priority [deadline]`; '#' starts a comment. The burst may be
+// a comma list `cpu,io,cpu,...` (odd length) for a job that does I/O.
+static bool parseWorkload(const char* p, const char* end, Workload& ps, IdTable& ids) {
+    auto blank=[](char c){ return c==' '||c=='\t'||c=='\r'; };
+    auto skipComment=[&]{ const char* nl=(const char*)memchr(p,'\n',end-p); p=nl? nl : end; };
+    int line=1;
+    std::vector<int32_t> bursts;
+    while(p<end){
+        char c=*p;
+        if(c=='\n'){ ++p; ++line; continue; }
+        if(blank(c)){ ++p; continue; }
+        if(c=='#'){ skipComment(); continue; }
+        const char* id=p; while(p<end && !blank(*p) && *p!='\n' && *p!='#') ++p;
+        std::string_view name(id, p-id);
+        int v[4]; int k=0;
+        for(; k<4; ++k){
+            while(p<end && blank(*p)) ++p;
+            auto r=std::from_chars(p, end, v[k]);
+            if(r.ec!=std::errc()) break;
+            p=r.ptr;
+            if(k==1){
+                bursts.assign(1, v[1]);
+                while(p<end && *p==','){
+                    int b; r=std::from_chars(p+1, end, b);
+                    if(r.ec!=std::errc()){ bursts.clear(); break; }
+                    bursts.push_back(b); p=r.ptr;
+                }
+                if(bursts.size()%2==0) break; // a sequence ends with a CPU burst
+            }
+        }
+        while(p<end && blank(*p)) ++p;
+        if(p<end && *p=='#') skipComment();
+        if(k<3 || (p<end && *p!='\n')){ std::cerr<<"Parse error on line "<<line<<"\n"; return false; }
+        ProcId h=ids.intern(name);
+        Process row{h,v[0],v[1],v[2]}; if(k==4) row.deadline=v[3];
+        if(bursts.size()>1) ps.push_back(row, bursts.data(), bursts.size()); else ps.push_back(row);
+    }
+    return true;
+}
+
+// Read-only mmap of a whole file, unmapped on destruction.
+class MappedFile {
+    void* map = nullptr; size_t len = 0;
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { if (map) munmap(map, len); }
+    bool open(const std::string& filename) {
+        int fd=::open(filename.c_str(), O_RDONLY);
+        struct stat st;
+        if(fd<0 || fstat(fd,&st)!=0){ if(fd>=0) close(fd); return false; }
+        len=(size_t)st.st_size;
+        if(len>0){
+            map=mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(map==MAP_FAILED){ map=nullptr; len=0; close(fd); return false; }
+        }
+        close(fd);
+        return true;
+    }
+    const char* data() const { return (const char*)map; }
+    size_t size() const { return len; }
+};
+
+Workload loadProcesses(const std::string& filename, IdTable& ids) {
+    Workload ps;
+    MappedFile file;
+    if(!file.open(filename)){ std::cerr<<"Error opening file: "<<filename<<"\n"; return ps; }
+    auto t0=std::chrono::steady_clock::now();
+    size_t size=file.size();
+    if(size>0){
+        madvise((void*)file.data(), size, MADV_SEQUENTIAL);
+        // one row per line at most (blank and comment lines included), counted with memchr
+        size_t lines=0;
+        for(const char *p=file.data(), *end=p+size; (p=(const char*)memchr(p,'\n',end-p)); ++p) ++lines;
+        if(file.data()[size-1]!='\n') ++lines;
+        ps.reserve(lines); ids.reserve(lines);
+        if(!parseWorkload(file.data(), file.data()+size, ps, ids)){ ps.clear(); return ps; }
+    }
+    double sec=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+    ids.finalize(ps);
+    ps.sortByArrival();
+    double mb=size/1e6;
+    std::cerr<<"Loaded "<<ps.size()<<" processes ("<<mb<<" MB in "<<sec*1e3<<" ms, "
+             <<(sec>0? mb/sec : 0.0)<<" MB/s)\n";
     return ps;
 }
 
-std::vector<Process> generateRandomProcesses(int num) {
-    std::vector<Process> ps;
-    std::mt19937 gen((unsigned)std::chrono::system_clock::now().time_since_epoch().count());
-    std::uniform_int_distribution<int> at(0,20), bt(1,10), pri(0,5);
-    for(int i=0;i<num;++i){ ps.push_back({"P"+std::to_string(i+1), at(gen), bt(gen), pri(gen)}); }
-    std::sort(ps.begin(), ps.end(), [](auto&a,auto&b){return a.arrival_time<b.arrival_time;});
+// ---------- Binary workload format ----------
+// Columnar, already sorted by arrival, with the names stored in handle (= sorted)
+// order, so replaying a generated workload is an mmap plus a few pointer fixups.
+// Host byte order; every section starts on a 64-byte boundary:
+//   WorkloadHeader | name index (uint64 x names+1) | name bytes |
+//   id (uint32 x n) | arrival | burst | priority | deadline (int32 x n)
+struct WorkloadHeader {
+    char magic[8];
+    uint32_t version, reserved;
+    uint64_t n, names;
+    uint64_t off_name_index, off_name_bytes;
+    uint64_t off_id, off_arrival, off_burst, off_priority, off_deadline;
+    uint64_t file_size;
+};
+constexpr char WORKLOAD_MAGIC[8] = {'S','C','H','E','D','W','L','\0'};
+constexpr uint32_t WORKLOAD_VERSION = 1;
+
+#ifndef SIMULATOR_NO_MAIN
+static bool isBinaryWorkload(const std::string& filename) {
+    char magic[8] = {};
+    std::ifstream f(filename, std::ios::binary);
+    return f.read(magic, 8) && memcmp(magic, WORKLOAD_MAGIC, 8)==0;
+}
+#endif
+
+bool writeBinaryWorkload(const std::string& filename, const Workload& ps, const IdTable& ids) {
+    if (ps.seq_off) { std::cerr<<"The binary format has no I/O bursts; keep this workload as text\n"; return false; }
+    auto align=[](uint64_t off){ return (off+63)&~uint64_t(63); };
+    WorkloadHeader h{}; memcpy(h.magic, WORKLOAD_MAGIC, 8); h.version=WORKLOAD_VERSION;
+    h.n=ps.size(); h.names=ids.size();
+    std::vector<uint64_t> index(h.names+1, 0);
+    for (uint64_t i=0;i<h.names;++i) index[i+1]=index[i]+ids.name((ProcId)i).size();
+    h.off_name_index=align(sizeof h);
+    h.off_name_bytes=align(h.off_name_index+index.size()*sizeof(uint64_t));
+    h.off_id=align(h.off_name_bytes+index.back());
+    h.off_arrival=align(h.off_id+h.n*4);
+    h.off_burst=align(h.off_arrival+h.n*4);
+    h.off_priority=align(h.off_burst+h.n*4);
+    h.off_deadline=align(h.off_priority+h.n*4);
+    h.file_size=h.off_deadline+h.n*4;
+
+    std::ofstream f(filename, std::ios::binary);
+    if(!f){ std::cerr<<"Error opening file: "<<filename<<"\n"; return false; }
+    std::vector<char> buf(1<<20); f.rdbuf()->pubsetbuf(buf.data(), buf.size());
+    uint64_t pos=0;
+    auto put=[&](const void* p, uint64_t bytes){ f.write((const char*)p, bytes); pos+=bytes; };
+    auto pad=[&](uint64_t to){ static const char zero[64]={}; while(pos<to){ uint64_t k=std::min<uint64_t>(to-pos,64); put(zero,k); } };
+    auto column=[&](uint64_t off, const void* col){ pad(off); put(col, h.n*4); };
+    put(&h, sizeof h);
+    pad(h.off_name_index); put(index.data(), index.size()*sizeof(uint64_t));
+    pad(h.off_name_bytes);
+    for (uint64_t i=0;i<h.names;++i){ auto nm=ids.name((ProcId)i); put(nm.data(), nm.size()); }
+    column(h.off_id, ps.id);
+    column(h.off_arrival, ps.arrival);
+    column(h.off_burst, ps.burst);
+    column(h.off_priority, ps.priority);
+    column(h.off_deadline, ps.deadline);
+    f.flush();
+    if(!f){ std::cerr<<"Error writing file: "<<filename<<"\n"; return false; }
+    return true;
+}
+
+// The mapped columns of a binary workload. The IdTable and the borrowed Workload
+// read straight out of the mapping, so this must outlive both.
+struct BinaryWorkload {
+    MappedFile file;
+    const WorkloadHeader* header = nullptr;
+    const ProcId* id = nullptr;
+    const int32_t *arrival = nullptr, *burst = nullptr, *priority = nullptr, *deadline = nullptr;
+
+    bool open(const std::string& filename, IdTable& ids) {
+        if(!file.open(filename) || file.size()<sizeof(WorkloadHeader)){ std::cerr<<"Error opening file: "<<filename<<"\n"; return false; }
+        header=(const WorkloadHeader*)file.data();
+        const WorkloadHeader& h=*header;
+        if(memcmp(h.magic, WORKLOAD_MAGIC, 8)!=0 || h.version!=WORKLOAD_VERSION || h.file_size!=file.size() || !valid(h)){
+            std::cerr<<"Bad binary workload: "<<filename<<"\n"; header=nullptr; return false;
+        }
+        auto at=[&](uint64_t off){ return file.data()+off; };
+        id=(const ProcId*)at(h.off_id);
+        arrival=(const int32_t*)at(h.off_arrival); burst=(const int32_t*)at(h.off_burst);
+        priority=(const int32_t*)at(h.off_priority); deadline=(const int32_t*)at(h.off_deadline);
+        ids.attach((const uint64_t*)at(h.off_name_index), at(h.off_name_bytes), h.names);
+        return true;
+    }
+    // The header and the mapped data are untrusted: every section must lie inside
+    // the file and be aligned for its type, every id must name an entry of the
+    // string table, the name index must be monotonic and stay inside the name
+    // bytes, and arrivals must be sorted and non-negative, as the writer leaves them.
+    bool valid(const WorkloadHeader& h) const {
+        const uint64_t size=file.size();
+        auto fits=[&](uint64_t off, uint64_t bytes){ return off<=size && bytes<=size-off; };
+        if(h.n>size/4 || h.names>=size/8) return false;
+        const uint64_t cols[]={h.off_id, h.off_arrival, h.off_burst, h.off_priority, h.off_deadline};
+        for(uint64_t off : cols) if(off%4!=0 || !fits(off, h.n*4)) return false;
+        if(h.off_name_index%8!=0 || !fits(h.off_name_index, (h.names+1)*8) || h.off_name_bytes>size) return false;
+        const uint64_t* index=(const uint64_t*)(file.data()+h.off_name_index);
+        if(index[0]!=0) return false;
+        for(uint64_t i=0;i<h.names;++i) if(index[i+1]<index[i]) return false;
+        if(!fits(h.off_name_bytes, index[h.names])) return false;
+        const ProcId* ids=(const ProcId*)(file.data()+h.off_id);
+        const int32_t* arr=(const int32_t*)(file.data()+h.off_arrival);
+        for(uint64_t i=0;i<h.n;++i){
+            if(ids[i]>=h.names || arr[i]<0) return false;
+            if(i>0 && arr[i]<arr[i-1]) return false;
+        }
+        return true;
+    }
+    size_t size() const { return header ? header->n : 0; }
+    // Zero-copy: the schedulers read the mapped columns directly.
+    Workload view() const { Workload w; w.borrow(size(), id, arrival, burst, priority, deadline); return w; }
+};
+
+
+// ---------- Synthetic workloads ----------
+// Parallel for work that must not depend on the thread count: callers split it
+// into fixed-size chunks and seed each chunk from (seed, chunk index).
+// Worker count for parallelFor(); 0 = one per hardware thread (--threads).
+static unsigned g_threads = 0;
+static unsigned threadCount() { return g_threads ? g_threads : std::max(1u, std::thread::hardware_concurrency()); }
+
+// Runs fn(0..count-1) on a fixed pool of worker threads that pull the next
+// index from a shared counter.
+void parallelFor(size_t count, const std::function<void(size_t)>& fn, unsigned threads = 0) {
+    if (threads == 0) threads = threadCount();
+    threads = (unsigned)std::min<size_t>(threads, count);
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < threads; ++w)
+        pool.emplace_back([&]{ for (size_t i; (i = next++) < count; ) fn(i); });
+    for (auto& th : pool) th.join();
+}
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+struct GenSpec {
+    long long n = 10;
+    uint64_t seed = 0;
+    std::string arrival = "poisson";   // poisson | bursty | uniform
+    std::string burst = "uniform";     // uniform | exp | pareto | bimodal
+    double rate = 0.2;                 // mean arrivals per time unit
+    double mean_burst = 5;
+    int io_bursts = 0;                 // I/O bursts per job, each between two CPU bursts
+    double mean_io = 10;               // exponential I/O burst length
+};
+
+// Generates processes in arrival order by construction: every chunk of CHUNK
+// processes draws its own inter-arrival gaps and bursts from an RNG seeded by
+// (seed, chunk), chunks are generated in parallel, and a serial prefix sum over
+// the chunk spans places them on the timeline. The output is the same for any
+// thread count, and run() only holds one batch of chunks at a time.
+class WorkloadGenerator {
+public:
+    static constexpr long long CHUNK = 1 << 16;
+    struct Chunk {
+        long long first = 0; std::vector<double> at; std::vector<int> burst, priority; double span = 0;
+        std::vector<int32_t> seq;   // io_bursts > 0: each job's CPU,IO,...,CPU bursts, stride() apiece
+    };
+    size_t stride() const { return 2 * (size_t)spec.io_bursts + 1; }
+
+    explicit WorkloadGenerator(const GenSpec& s) : spec(s) {}
+    static bool valid(const GenSpec& s) {
+        bool a = s.arrival=="poisson" || s.arrival=="bursty" || s.arrival=="uniform";
+        bool b = s.burst=="uniform" || s.burst=="exp" || s.burst=="pareto" || s.burst=="bimodal";
+        return a && b && s.n > 0 && s.rate > 0 && s.mean_burst >= 1 && s.io_bursts >= 0 && s.mean_io >= 1;
+    }
+    long long chunks() const { return (spec.n + CHUNK - 1) / CHUNK; }
+
+    void fill(long long k, Chunk& c) const {
+        std::mt19937_64 gen(splitmix64(spec.seed ^ splitmix64((uint64_t)k)));
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        std::uniform_int_distribution<int> pri(0, 5);
+        double gap = 1.0 / spec.rate, m = spec.mean_burst;
+        auto expo = [&](double mean){ return -mean * std::log1p(-u(gen)); };
+        c.first = k * CHUNK;
+        long long len = std::min(CHUNK, spec.n - c.first);
+        c.at.resize(len); c.burst.resize(len); c.priority.resize(len);
+        c.seq.resize(spec.io_bursts > 0 ? len * stride() : 0);
+        auto draw = [&]{
+            double b;
+            if (spec.burst == "exp") b = 1 + expo(m - 1);
+            else if (spec.burst == "pareto") { const double alpha = 1.5; b = m * (alpha - 1) / alpha / std::pow(1 - u(gen), 1 / alpha); }
+            else if (spec.burst == "bimodal") b = u(gen) < 0.8 ? 1 + expo(0.25 * m) : 1 + expo(4 * m);
+            else b = 1 + std::floor(u(gen) * 2 * m);
+            return (int)std::min(std::max(b, 1.0), 1e9);
+        };
+        double t = 0;
+        for (long long i = 0; i < len; ++i) {
+            if (spec.arrival == "poisson") t += expo(gap);
+            else if (spec.arrival == "bursty") t += u(gen) < 0.9 ? expo(0.2 * gap) : expo(8.2 * gap); // same mean, clumped
+            else t += u(gen) * 2 * gap;
+            c.at[i] = t;
+            c.burst[i] = draw();
+            c.priority[i] = pri(gen);
+            if (!c.seq.empty()) {
+                int32_t* b = &c.seq[i * stride()];
+                b[0] = c.burst[i];
+                for (size_t j = 1; j < stride(); j += 2) {
+                    b[j] = (int)std::min(1 + expo(spec.mean_io - 1), 1e9);
+                    b[j + 1] = draw();
+                }
+            }
+        }
+        c.span = t;
+    }
+
+    // Calls sink(chunk) for every chunk in order, with c.at already absolute.
+    // Returns false if arrival times would not fit in an int.
+    template <class Sink> bool run(Sink&& sink, unsigned threads = 0) const {
+        if (threads == 0) threads = threadCount();
+        std::vector<Chunk> batch(threads * 4);
+        double offset = 0;
+        for (long long k0 = 0; k0 < chunks(); k0 += (long long)batch.size()) {
+            long long cnt = std::min((long long)batch.size(), chunks() - k0);
+            parallelFor((size_t)cnt, [&](size_t j){ fill(k0 + (long long)j, batch[j]); }, threads);
+            for (long long j = 0; j < cnt; ++j) {
+                Chunk& c = batch[j];
+                for (double& a : c.at) a = std::floor(offset + a);
+                offset += c.span;
+                if (!c.at.empty() && c.at.back() > INT_MAX) return false;
+                sink(c);
+            }
+        }
+        return true;
+    }
+private:
+    GenSpec spec;
+};
+
+Workload generateRandomProcesses(const GenSpec& spec, IdTable& ids) {
+    Workload ps;
+    if (spec.n > INT_MAX) { std::cerr<<"Too many processes to keep in memory; use --emit\n"; return ps; }
+    ps.reserve(spec.n); ids.reserve(spec.n);
+    WorkloadGenerator generator(spec);
+    bool ok = generator.run([&](const WorkloadGenerator::Chunk& c){
+        for (size_t i = 0; i < c.at.size(); ++i) {
+            Process p{ids.intern("P" + std::to_string(c.first + (long long)i + 1)), (int)c.at[i], c.burst[i], c.priority[i]};
+            if (c.seq.empty()) ps.push_back(p);
+            else ps.push_back(p, &c.seq[i * generator.stride()], generator.stride());
+        }
+    });
+    if (!ok) { std::cerr<<"Arrival times overflow; raise --rate\n"; ps.clear(); return ps; }
+    ids.finalize(ps);
     return ps;
 }
 
+// Streams the generated workload as text (the --input format) without ever
+// holding more than one batch of chunks. "-" writes to stdout.
+bool emitRandomProcesses(const GenSpec& spec, const std::string& filename) {
+    FILE* out = filename == "-" ? stdout : fopen(filename.c_str(), "w");
+    if (!out) { std::cerr<<"Error opening file: "<<filename<<"\n"; return false; }
+    std::vector<char> buf(1 << 20);
+    WorkloadGenerator generator(spec);
+    size_t k = spec.io_bursts > 0 ? generator.stride() : 1;
+    if (buf.size() < 64 + 12 * k) buf.resize(64 + 12 * k);
+    bool ok = generator.run([&](const WorkloadGenerator::Chunk& c){
+        char* p = buf.data();
+        for (size_t i = 0; i < c.at.size(); ++i) {
+            if ((size_t)(buf.data() + buf.size() - p) < 64 + 12 * k) { fwrite(buf.data(), 1, p - buf.data(), out); p = buf.data(); }
+            char* e = buf.data() + buf.size();
+            *p++ = 'P'; p = std::to_chars(p, e, c.first + (long long)i + 1).ptr;
+            *p++ = ' '; p = std::to_chars(p, e, (long long)c.at[i]).ptr;
+            *p++ = ' '; p = std::to_chars(p, e, c.burst[i]).ptr;
+            for (size_t j = 1; j < k; ++j) { *p++ = ','; p = std::to_chars(p, e, c.seq[i * k + j]).ptr; }
+            *p++ = ' '; p = std::to_chars(p, e, c.priority[i]).ptr;
+            *p++ = '\n';
+        }
+        fwrite(buf.data(), 1, p - buf.data(), out);
+    });
+    if (out != stdout) fclose(out); else fflush(out);
+    if (!ok) std::cerr<<"Arrival times overflow; raise --rate\n";
+    return ok;
+}
+
+// Long-burst workload for --bench: mean burst ~100 and slightly overloaded arrivals,
+// so the ready queue keeps growing and total CPU time is ~100x the job count.
+Workload generateBenchProcesses(int num, unsigned seed, IdTable& ids) {
+    Workload ps; ps.reserve(num);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> gap(0,190), bt(50,150), pri(0,5), slack(2,5);
+    int t=0;
+    for(int i=0;i<num;++i){
+        t+=gap(gen); int b=bt(gen);
+        ps.push_back({ids.intern("P"+std::to_string(i+1)), t, b, pri(gen), t+b*slack(gen)});
+    }
+    ids.finalize(ps);
+    return ps;
+}
+
+// ---------- Scheduler factory ----------
+// Tunable knobs. The defaults are the values that used to be hardcoded.
+struct SchedConfig {
+    int quantum = 4;                                     // rr
+    long long tickets = 10;                              // lottery
+    uint64_t seed = 1;                                   //   draws; main sets --seed, else the clock
+    int mlq_quantum = 4, mlq_split = 3;                  // mlq (two classes: rr/quantum below split, fcfs)
+    std::vector<MLQClass> mlq_classes;                   //   explicit class list; overrides the above
+    int mlfq_quantum = 2, mlfq_levels = 3, mlfq_age = 10; // mlfq (quantum doubles per level)
+    int mlfq_boost = 0;                                  //   global boost period, 0 = off
+    std::vector<int> mlfq_quanta;                        //   explicit per-level quanta; overrides the above
+    int cfs_latency = 16, cfs_granularity = 2;           // cfs (targeted latency, minimum granularity)
+    int cpus = 1, migrate_cost = 0;                      // rr, cfs, mlfq on several CPUs (SmpScheduler)
+    int switch_cost = 0, warmup = 0;                     // every scheduler (SwitchCost)
+};
+
+static std::unique_ptr<Scheduler> makePolicy(const std::string& sched, const SchedConfig& cfg) {
+    if (sched=="fcfs") return std::make_unique<FCFSScheduler>();
+    if (sched=="sjf") return std::make_unique<SJFScheduler>();
+    if (sched=="srtf") return std::make_unique<SRTFScheduler>();
+    if (sched=="prio" || sched=="priority") return std::make_unique<PriorityScheduler>();
+    if (sched=="rr") return std::make_unique<RoundRobinScheduler>(cfg.quantum);
+    if (sched=="mlq") return cfg.mlq_classes.empty() ? std::make_unique<MLQScheduler>(cfg.mlq_quantum, cfg.mlq_split)
+                                                     : std::make_unique<MLQScheduler>(cfg.mlq_classes);
+    if (sched=="mlfq") {
+        std::vector<int> quanta = cfg.mlfq_quanta;
+        if (quanta.empty()) for (int k = 0; k < cfg.mlfq_levels; ++k) quanta.push_back(cfg.mlfq_quantum << k);
+        return std::make_unique<MLFQScheduler>(quanta, cfg.mlfq_age, cfg.mlfq_boost);
+    }
+    if (sched=="lottery") return std::make_unique<LotteryScheduler>(cfg.tickets, cfg.seed);
+    if (sched=="cfs") return std::make_unique<CFSScheduler>(cfg.cfs_latency, cfg.cfs_granularity);
+    if (sched=="edf") return std::make_unique<EDFScheduler>();
+    return nullptr;
+}
+
+std::unique_ptr<Scheduler> makeScheduler(const std::string& sched, const SchedConfig& cfg = SchedConfig()) {
+    std::unique_ptr<Scheduler> s = makePolicy(sched, cfg);
+    if (s) s->overhead = {cfg.switch_cost, cfg.warmup};
+    return s;
+}
+
+// ---------- SMP ----------
+// --cpus N runs rr, cfs or mlfq on N CPUs, each with its own runqueue and its
+// own Gantt lane. A new job (or one back from I/O) goes to an idle CPU if there
+// is one, else to the least loaded one. A CPU whose runqueue is empty steals the last queued job of
+// the longest runqueue and, with --migrate-cost C, spends C units moving it (a
+// MIGRATE block). CPUs decide at slice boundaries only: an arrival never cuts
+// a running slice short, so with one CPU only rr matches its single-CPU class.
+class CpuQueue {
+public:
+    virtual ~CpuQueue() = default;
+    virtual void arrive(int j, int t) { push(j, t); }        // a new job placed here
+    virtual void push(int j, int t) = 0;                     // ready again after a slice
+    virtual int pop(int t) = 0;                              // next job to run
+    virtual int steal() = 0;                                 // hand a queued job to another CPU
+    virtual void migrateIn(int j, int t) { push(j, t); }     // a job stolen from another CPU
+    virtual void wake(int j, int t) { push(j, t); }          // a job back from I/O placed here
+    virtual int slice(int j) const = 0;                      // for the job just popped
+    // j ran len units; `left` if its CPU burst is over (done, or blocked on I/O)
+    virtual void ran(int j, int len, bool left) { (void)j; (void)len; (void)left; }
+    virtual size_t size() const = 0;
+    virtual int level(int j) const { (void)j; return -1; }   // MLFQ level for the counter
+};
+
+class RrCpuQueue : public CpuQueue {
+    std::pmr::deque<int> q; int quantum;
+public:
+    RrCpuQueue(int qn, std::pmr::memory_resource* mem) : q(mem), quantum(qn) {}
+    void push(int j, int) override { q.push_back(j); }
+    int pop(int) override { int j = q.front(); q.pop_front(); return j; }
+    int steal() override { int j = q.back(); q.pop_back(); return j; }
+    int slice(int) const override { return quantum; }
+    size_t size() const override { return q.size(); }
+};
+
+// Per-CPU CFS: the same weights, slices, START_DEBIT and sleeper placement as
+// CFSScheduler, with vruntime made relative to min_vruntime while a task moves
+// between CPUs or sleeps on I/O (as the kernel does on migration). No wakeup
+// preemption.
+class CfsCpuQueue : public CpuQueue {
+    std::pmr::vector<int64_t>& vr; const std::pmr::vector<int>& w;   // shared per-job state
+    std::pmr::set<std::pair<int64_t,int>> rq;
+    int64_t min_vr = 0, queued_w = 0; int running = -1, latency, gran;
+    int share(int j, int64_t nr, int64_t total_w) const {
+        int64_t period = std::max<int64_t>(latency, nr * gran);
+        return (int)std::max<int64_t>(1, std::min<int64_t>(INT_MAX, period * w[j] / total_w));
+    }
+public:
+    CfsCpuQueue(std::pmr::vector<int64_t>& vruntime, const std::pmr::vector<int>& weight, int latency_units, int gran_units,
+                std::pmr::memory_resource* mem)
+        : vr(vruntime), w(weight), rq(mem), latency(latency_units), gran(gran_units) {}
+    void arrive(int j, int) override {
+        int64_t nr = (int64_t)rq.size() + (running >= 0) + 1;
+        int64_t total = queued_w + (running >= 0 ? w[running] : 0) + w[j];
+        vr[j] = min_vr + CFSScheduler::calcDeltaFair(share(j, nr, total), w[j]);
+        push(j, 0);
+    }
+    void push(int j, int) override { rq.insert({vr[j], j}); queued_w += w[j]; }
+    int pop(int) override {
+        int j = rq.begin()->second; rq.erase(rq.begin()); queued_w -= w[j];
+        running = j; return j;
+    }
+    int steal() override {
+        auto it = std::prev(rq.end()); int j = it->second; rq.erase(it); queued_w -= w[j];
+        vr[j] -= min_vr; return j;
+    }
+    void migrateIn(int j, int) override { vr[j] += min_vr; push(j, 0); }
+    void wake(int j, int) override {
+        vr[j] = std::max(vr[j] + min_vr, min_vr - ((int64_t)latency << CFSScheduler::VSHIFT) / 2);
+        push(j, 0);
+    }
+    int slice(int j) const override { return share(j, (int64_t)rq.size() + 1, queued_w + w[j]); }
+    void ran(int j, int len, bool left) override {
+        vr[j] += CFSScheduler::calcDeltaFair(len, w[j]);
+        int64_t v = left ? INT64_MAX : vr[j];
+        if (!rq.empty()) v = std::min(v, rq.begin()->first);
+        if (v != INT64_MAX) min_vr = std::max(min_vr, v);
+        if (left) vr[j] -= min_vr;
+        running = -1;
+    }
+    size_t size() const override { return rq.size(); }
+};
+
+// Per-CPU MLFQ: RR per level, demotion on a full slice. Aging and the boost
+// are checked when the CPU next picks a job rather than by timers.
+class MlfqCpuQueue : public CpuQueue {
+    std::pmr::vector<std::pmr::deque<std::pair<int,int>>> q;   // (job, enqueued at) per level
+    std::pmr::vector<int>& lvl; const std::pmr::vector<int>& quanta; int age, boost, next_boost; size_t count = 0;
+    void enq(int j, int k, int t) { lvl[j] = k; q[k].push_back({j, t}); ++count; }
+public:
+    MlfqCpuQueue(std::pmr::vector<int>& level, const std::pmr::vector<int>& level_quanta, int age_units, int boost_period,
+                 std::pmr::memory_resource* mem)
+        : q(level_quanta.size(), mem), lvl(level), quanta(level_quanta), age(age_units), boost(boost_period), next_boost(boost_period) {}
+    void arrive(int j, int t) override { enq(j, 0, t); }
+    void push(int j, int t) override { enq(j, lvl[j], t); }
+    int pop(int t) override {
+        int L = (int)q.size();
+        if (boost > 0 && t >= next_boost) {
+            for (int k = 1; k < L; ++k) for (auto& e : q[k]) { lvl[e.first] = 0; q[0].push_back({e.first, t}); }
+            for (int k = 1; k < L; ++k) q[k].clear();
+            next_boost = (t / boost + 1) * boost;
+        }
+        for (int k = 1; k < L; ++k)
+            while (!q[k].empty() && t - q[k].front().second >= age) {
+                int j = q[k].front().first; q[k].pop_front(); --count; enq(j, k - 1, t);
+            }
+        for (auto& level : q)
+            if (!level.empty()) { int j = level.front().first; level.pop_front(); --count; return j; }
+        return -1;
+    }
+    int steal() override {
+        for (int k = (int)q.size() - 1; k >= 0; --k)
+            if (!q[k].empty()) { int j = q[k].back().first; q[k].pop_back(); --count; return j; }
+        return -1;
+    }
+    int slice(int j) const override { return quanta[lvl[j]]; }
+    void ran(int j, int len, bool left) override {
+        if (!left && len == quanta[lvl[j]] && lvl[j] + 1 < (int)q.size()) ++lvl[j];
+    }
+    size_t size() const override { return count; }
+    int level(int j) const override { return lvl[j]; }
+};
+
+struct SmpStats { std::pmr::vector<long long> busy; long long migrations = 0; };   // busy lives in the run's memory
+
+class SmpScheduler {
+    std::string policy; SchedConfig cfg;
+public:
+    static bool supports(const std::string& sched) { return sched=="rr" || sched=="cfs" || sched=="mlfq"; }
+    SmpScheduler(std::string sched, const SchedConfig& c) : policy(std::move(sched)), cfg(c) {}
+
+    // lanes[c] receives CPU c's blocks; every lane is padded with IDLE to total_time.
+    SmpStats schedule(const Workload& ps, RunState& st, std::vector<Gantt>& lanes, int& total_time) {
+        initRun(ps, st);
+        int n = (int)ps.size(), N = (int)lanes.size(), t = 0, done = 0;
+        JobEvents jobs(ps, st);
+        std::pmr::vector<int> lvl(n, 0, st.mem), weight(n, st.mem);
+        std::pmr::vector<int64_t> vr(n, 0, st.mem);
+        std::pmr::vector<int> quanta(cfg.mlfq_quanta.begin(), cfg.mlfq_quanta.end(), st.mem);
+        if (quanta.empty()) for (int k = 0; k < cfg.mlfq_levels; ++k) quanta.push_back(cfg.mlfq_quantum << k);
+        for (int i = 0; i < n; ++i) weight[i] = CFSScheduler::weightOf(ps.priority[i]);
+
+        struct Cpu {
+            CpuQueue* q = nullptr;
+            int cur = -1; bool migrating = false; int start = 0;
+            int clock = 0; ProcId open = NO_ID; int open_len = 0;   // lane position; pending block
+            CpuContext ctx;
+        };
+        std::pmr::vector<Cpu> cpu(N, st.mem);
+        // the runqueues live in the run's memory too (a deque never moves them)
+        std::pmr::deque<RrCpuQueue> rr_q(st.mem);
+        std::pmr::deque<CfsCpuQueue> cfs_q(st.mem);
+        std::pmr::deque<MlfqCpuQueue> mlfq_q(st.mem);
+        for (auto& c : cpu) {
+            if (policy == "rr") c.q = &rr_q.emplace_back(cfg.quantum, st.mem);
+            else if (policy == "cfs") c.q = &cfs_q.emplace_back(vr, weight, cfg.cfs_latency, cfg.cfs_granularity, st.mem);
+            else c.q = &mlfq_q.emplace_back(lvl, quanta, cfg.mlfq_age, cfg.mlfq_boost, st.mem);
+        }
+        SmpStats stats{std::pmr::vector<long long>(N, 0, st.mem)};
+        using Event = std::pair<int,int>;   // (time, cpu): the CPU's slice or migration ends
+        std::priority_queue<Event, std::pmr::vector<Event>, std::greater<Event>> ev(std::greater<Event>(), std::pmr::vector<Event>(st.mem));
+
+        // consecutive blocks of the same job on one lane are merged, as in the single-CPU chart
+        auto emit = [&](int c, ProcId id, int len) {
+            Cpu& k = cpu[c];
+            if (len <= 0) return;
+            if (k.open != id) { if (k.open != NO_ID) lanes[c].emplace_back(k.open, k.open_len); k.open = id; k.open_len = 0; }
+            k.open_len += len; k.clock += len;
+        };
+        auto idleTo = [&](int c, int until) { emit(c, IDLE_ID, until - cpu[c].clock); };
+        SwitchCost sc{cfg.switch_cost, cfg.warmup};
+        auto start = [&](int c, int j) {
+            Cpu& k = cpu[c];
+            idleTo(c, t); SIM_STAT(decisions);
+            int over = switchTo(sc, st, k.ctx, c, j, t);
+            emit(c, SWITCH_ID, over);
+            onDispatch(ps, st, j, t + over);
+            lanes[c].counter(CTR_READY, t, (long long)k.q->size());
+            if (k.q->level(j) >= 0) lanes[c].counter(CTR_MLFQ_LEVEL, t, k.q->level(j));
+            k.cur = j; k.migrating = false; k.start = t + over;
+            ev.push({k.start + std::min(k.q->slice(j), st.remaining[j]), c});
+        };
+        auto place = [&](int j) {
+            int best = 0; size_t best_load = SIZE_MAX;
+            for (int c = 0; c < N; ++c) {
+                size_t load = cpu[c].q->size() + (cpu[c].cur >= 0);
+                if (load < best_load) { best = c; best_load = load; }
+            }
+            if (jobs.wakeup(j)) cpu[best].q->wake(j, t); else cpu[best].q->arrive(j, t);
+            SIM_STAT(pushes);
+        };
+        std::pmr::vector<std::pair<int,int>> requeue(st.mem);   // (cpu, job) preempted at t
+        requeue.reserve(N);
+        while (done < n) {
+            int te = ev.empty() ? INT_MAX : ev.top().first;
+            int ta = jobs.peek();
+            t = std::min(te, ta);
+            requeue.clear();
+            while (!ev.empty() && ev.top().first == t) {
+                int c = ev.top().second; ev.pop();
+                Cpu& k = cpu[c]; int j = k.cur; k.cur = -1;
+                if (k.migrating) { emit(c, MIGRATE_ID, t - k.start); k.q->migrateIn(j, t); SIM_STAT(pushes); continue; }
+                int len = t - k.start;
+                st.remaining[j] -= len; stats.busy[c] += len; emit(c, ps.id[j], len);
+                bool left = st.remaining[j] == 0;
+                k.q->ran(j, len, left);
+                if (!left) requeue.push_back({c, j});
+                else if (jobs.burstDone(j, t)) ++done;
+            }
+            while (jobs.peek() <= t) place(jobs.take());
+            // a preempted job goes back behind the arrivals, like the single-CPU RR
+            for (auto [c, j] : requeue) { cpu[c].q->push(j, t); SIM_STAT(pushes); SIM_STAT(preemptions); }
+            for (int c = 0; c < N; ++c) if (cpu[c].cur < 0 && cpu[c].q->size() > 0) { start(c, cpu[c].q->pop(t)); SIM_STAT(pops); }
+            for (int c = 0; c < N; ++c) {
+                if (cpu[c].cur >= 0) continue;
+                int victim = -1; size_t most = 0;
+                for (int d = 0; d < N; ++d) if (cpu[d].q->size() > most) { victim = d; most = cpu[d].q->size(); }
+                if (victim < 0) break;
+                int j = cpu[victim].q->steal(); ++stats.migrations; SIM_STAT(pops);
+                if (cfg.migrate_cost > 0) {
+                    idleTo(c, t);
+                    cpu[c].cur = j; cpu[c].migrating = true; cpu[c].start = t;
+                    ev.push({t + cfg.migrate_cost, c});
+                } else { cpu[c].q->migrateIn(j, t); start(c, cpu[c].q->pop(t)); SIM_STAT(pushes); SIM_STAT(pops); }
+            }
+        }
+        total_time = t;
+        for (int c = 0; c < N; ++c) {
+            idleTo(c, t);
+            if (cpu[c].open != NO_ID) lanes[c].emplace_back(cpu[c].open, cpu[c].open_len);
+        }
+        return stats;
+    }
+};
+
+// ---------- Bench ----------
+// Runs one scheduler on 10^5, 10^6, ... up to max_n jobs and prints how the
+// cost grows. For the event-driven schedulers ns/job should stay roughly flat
+// (n log n) even though the simulated CPU time is ~100x larger than n.
+int runBench(const std::string& sched, const SchedConfig& cfg, int max_n) {
+    std::cout << "Bench: " << sched << "\n";
+    std::cout << "jobs\tcpu_time\tblocks\tms\tns/job\n";
+    for (long long n = std::min(100000, max_n); n <= max_n; n *= 10) {
+        IdTable ids;
+        Workload ps = generateBenchProcesses((int)n, 42, ids);
+        auto scheduler = makeScheduler(sched, cfg);
+        RunState st;
+        Gantt gantt(nullptr);   // count blocks only
+        int total_time = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        scheduler->schedule(ps, st, gantt, total_time);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << n << "\t" << total_time << "\t" << gantt.size() << "\t" << ms << "\t" << ms * 1e6 / n << "\n";
+    }
+    return 0;
+}
+
+
+// ---------- Hardware counters (--perf) ----------
+// One perf_event_open group (cycles leads; instructions, cache misses and branch
+// misses follow) counting this thread in user space only, so what it measures
+// is the schedule() call and nothing else. Events the kernel or the PMU refuses
+// are left out; if even cycles is refused (no PMU in a VM, perf_event_paranoid,
+// a seccomp filter) the run goes ahead and --perf only says why.
+class PerfGroup {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, CACHE_REFERENCES, EVENTS };
+    static constexpr const char* NAMES[EVENTS] = {"Cycles", "Instructions", "Cache Misses", "Branch Misses", "Cache References"};
+    PerfGroup() { std::fill(fd, fd + EVENTS, -1); }
+    ~PerfGroup() { for (int f : fd) if (f >= 0) close(f); }
+    PerfGroup(const PerfGroup&) = delete;
+    PerfGroup& operator=(const PerfGroup&) = delete;
+
+    bool open() {
+#ifdef __linux__
+        static const uint64_t config[EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+                                                PERF_COUNT_HW_CACHE_REFERENCES};
+        for (int e = 0; e < EVENTS; ++e) {
+            perf_event_attr attr{};
+            attr.size = sizeof attr; attr.type = PERF_TYPE_HARDWARE; attr.config = config[e];
+            attr.disabled = e == 0; attr.exclude_kernel = 1; attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, fd[0], 0);
+            if (fd[e] < 0) {
+                if (e == 0) { error = std::string("perf_event_open: ") + strerror(errno); return false; }
+                continue;
+            }
+            if (ioctl(fd[e], PERF_EVENT_IOC_ID, &id[e]) < 0) { close(fd[e]); fd[e] = -1; }
+        }
+        return true;
+#else
+        error = "perf_event_open needs Linux";
+        return false;
+#endif
+    }
+    void start() {
+#ifdef __linux__
+        if (fd[0] < 0) return;
+        ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+    // Stops the group and reads it. Counts are scaled up by enabled/running if
+    // the PMU had to multiplex the group.
+    void stop() {
+#ifdef __linux__
+        if (fd[0] < 0) return;
+        ioctl(fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        struct { uint64_t nr, enabled, running; struct { uint64_t value, id; } v[EVENTS]; } buf{};
+        if (read(fd[0], &buf, sizeof buf) <= 0) { error = std::string("reading counters: ") + strerror(errno); return; }
+        double scale = buf.running ? (double)buf.enabled / buf.running : 0;
+        if (!buf.running) error = "the PMU never scheduled the counter group";
+        for (uint64_t k = 0; k < buf.nr && k < EVENTS; ++k)
+            for (int e = 0; e < EVENTS; ++e)
+                if (fd[e] >= 0 && id[e] == buf.v[k].id) value[e] = (long long)(buf.v[k].value * scale);
+#endif
+    }
+    bool has(Event e) const { return fd[e] >= 0 && value[e] >= 0; }
+    long long get(Event e) const { return value[e]; }
+    const std::string& why() const { return error; }
+private:
+    int fd[EVENTS]; uint64_t id[EVENTS] = {}; long long value[EVENTS] = {-1, -1, -1, -1, -1};
+    std::string error;
+};
+
+// --perf 1 report. A decision is one Gantt block.
+void printPerf(const PerfGroup& perf, size_t decisions) {
+    if (!perf.why().empty()) { std::cout << "Perf Counters: unavailable (" << perf.why() << ")\n"; return; }
+    double per = decisions ? 1.0 / decisions : 0;
+    for (int e = 0; e < PerfGroup::EVENTS; ++e) {
+        auto ev = (PerfGroup::Event)e;
+        std::cout << PerfGroup::NAMES[e] << ": ";
+        if (!perf.has(ev)) { std::cout << "n/a\n"; continue; }
+        std::cout << perf.get(ev);
+        if (ev == PerfGroup::CACHE_MISSES || ev == PerfGroup::BRANCH_MISSES) std::cout << " (" << perf.get(ev) * per << " per decision)";
+        std::cout << "\n";
+    }
+    if (perf.has(PerfGroup::CYCLES) && perf.has(PerfGroup::INSTRUCTIONS) && perf.get(PerfGroup::CYCLES) > 0)
+        std::cout << "IPC: " << (double)perf.get(PerfGroup::INSTRUCTIONS) / perf.get(PerfGroup::CYCLES) << "\n";
+}
+
+// --bench-layout N: the two passes that dominate outside the queues (summing
+// bursts for the metrics, scanning arrivals for admission) over N jobs stored
+// as AoS rows in the original Process layout (string name, seven ints and a
+// double) and as Workload columns. Each pass runs inside a PerfGroup, so the
+// table carries cache misses and references per job where the counters open.
+int runLayoutBench(long long n) {
+    struct Row {   // Process before interning and the column split
+        std::string id;
+        int arrival_time, burst_time, priority;
+        int remaining_time = 0, waiting_time = 0, turnaround_time = 0;
+        int deadline = 0;
+        double vruntime = 0.0;
+    };
+    GenSpec spec; spec.n = n; spec.seed = 42;
+    IdTable ids;
+    Workload soa = generateRandomProcesses(spec, ids);
+    if (soa.empty()) return 1;
+    std::vector<Row> aos; aos.reserve(soa.size());
+    for (size_t i = 0; i < soa.size(); ++i) {
+        Row r{std::string(ids.name(soa.id[i])), soa.arrival[i], soa.burst[i], soa.priority[i]};
+        r.remaining_time = soa.burst[i]; r.deadline = soa.deadline[i];
+        aos.push_back(std::move(r));
+    }
+    const int passes = 10, cutoff = soa.arrival[soa.size() / 2];
+    volatile long long sink = 0;
+    PerfGroup perf;
+    if (!perf.open()) std::cerr << "Perf counters unavailable (" << perf.why() << "); misses show as n/a\n";
+    auto perJob = [&](PerfGroup::Event e) {
+        if (!perf.why().empty() || !perf.has(e)) return std::string("n/a");
+        std::ostringstream o; o << (double)perf.get(e) / passes / n; return o.str();
+    };
+    auto run = [&](const char* layout, const char* pass, size_t bytes, auto fn) {
+        auto t0 = std::chrono::steady_clock::now();
+        perf.start();
+        for (int k = 0; k < passes; ++k) sink = sink + fn();
+        perf.stop();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / passes;
+        std::cout << layout << "\t" << pass << "\t" << bytes << "\t" << ms << "\t" << ms * 1e6 / n
+                  << "\t" << perJob(PerfGroup::CACHE_MISSES) << "\t" << perJob(PerfGroup::CACHE_REFERENCES) << "\n";
+    };
+    std::cout << "layout\tpass\tbytes/job\tms\tns/job\tmisses/job\trefs/job\n";
+    run("aos", "burst_sum", sizeof(Row), [&]{ long long s = 0; for (auto& p : aos) s += p.burst_time; return s; });
+    run("soa", "burst_sum", sizeof(int32_t), [&]{ long long s = 0; for (size_t i = 0; i < soa.size(); ++i) s += soa.burst[i]; return s; });
+    run("aos", "arrival_scan", sizeof(Row), [&]{ long long c = 0; for (auto& p : aos) c += p.arrival_time <= cutoff; return c; });
+    run("soa", "arrival_scan", sizeof(int32_t), [&]{ long long c = 0; for (size_t i = 0; i < soa.size(); ++i) c += soa.arrival[i] <= cutoff; return c; });
+    return 0;
+}
+
+// ---------- Parallel runs ----------
+const std::vector<std::string> ALL_SCHEDULERS = {"fcfs","sjf","srtf","prio","rr","mlq","mlfq","lottery","cfs","edf"};
+
+// --scheduler all: every scheduler runs concurrently on the same read-only
+// workload, each with its own RunState, and the metrics are printed side by side.
+int runAll(const Workload& ps, const SchedConfig& cfg) {
+    struct Row { Metrics m; double ms; size_t blocks; };
+    std::vector<Row> rows(ALL_SCHEDULERS.size());
+    auto t0 = std::chrono::steady_clock::now();
+    parallelFor(rows.size(), [&](size_t k){
+        static thread_local RunArena arena;
+        arena.reserve(runFootprint(ps, false));
+        auto scheduler = makeScheduler(ALL_SCHEDULERS[k], cfg);
+        {
+            RunState st(arena.get()); Gantt gantt(nullptr); int total_time = 0;
+            auto r0 = std::chrono::steady_clock::now();
+            scheduler->schedule(ps, st, gantt, total_time);
+            Row& r = rows[k];
+            r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - r0).count();
+            r.blocks = gantt.size();
+            r.m = calculateMetrics(ps, st, total_time);
+        }
+        arena.reset();
+    });
+    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << std::left << std::setw(10) << "Scheduler" << std::right
+              << std::setw(14) << "Avg Wait" << std::setw(16) << "Avg Turnaround"
+              << std::setw(14) << "Avg Response" << std::setw(14) << "P99 Turn." << std::setw(14) << "Avg Slowdown"
+              << std::setw(12) << "CPU Util %" << std::setw(14) << "Throughput"
+              << std::setw(12) << "Switches" << std::setw(12) << "Switch %" << std::setw(12) << "Blocks" << std::setw(12) << "Time (ms)" << "\n";
+    double sum = 0;
+    for (size_t k = 0; k < rows.size(); ++k) {
+        const Row& r = rows[k]; sum += r.ms;
+        std::cout << std::left << std::setw(10) << ALL_SCHEDULERS[k] << std::right
+                  << std::setw(14) << r.m.wait.mean << std::setw(16) << r.m.turnaround.mean
+                  << std::setw(14) << r.m.response.mean << std::setw(14) << r.m.turnaround.p99 << std::setw(14) << r.m.slowdown.mean
+                  << std::setw(12) << r.m.cpu_util << std::setw(14) << r.m.throughput
+                  << std::setw(12) << r.m.switches << std::setw(12) << r.m.switch_pct << std::setw(12) << r.blocks << std::setw(12) << r.ms << "\n";
+    }
+    std::cout << "Wall time: " << wall << " ms (sum of runs " << sum << " ms)\n";
+    return 0;
+}
+
+// ---------- Parameter sweep ----------
+// Grid syntax for a knob: a single value, a list "2,4,8" or a range "lo:hi[:step]".
+// False on anything else (empty items, trailing text, step < 1, out-of-range
+// numbers) or on a grid of more than MAX_GRID values.
+constexpr size_t MAX_GRID = 1 << 16;
+bool parseGrid(const std::string& spec, std::vector<int>& out) {
+    out.clear();
+    const char* p = spec.data(); const char* end = p + spec.size();
+    auto number = [&](int& v){ auto r = std::from_chars(p, end, v); if (r.ec != std::errc() || r.ptr == p) return false; p = r.ptr; return true; };
+    if (spec.find(':') != std::string::npos) {
+        int lo, hi, step = 1;
+        if (!number(lo) || p == end || *p++ != ':' || !number(hi)) return false;
+        if (p != end && (*p++ != ':' || !number(step))) return false;
+        if (p != end || step < 1) return false;
+        for (long long x = lo; x <= hi; x += step) {   // long long: x + step must not wrap
+            if (out.size() == MAX_GRID) return false;
+            out.push_back((int)x);
+        }
+        return !out.empty();
+    }
+    while (true) {
+        int v;
+        if (!number(v) || out.size() == MAX_GRID) return false;
+        out.push_back(v);
+        if (p == end) return true;
+        if (*p++ != ',') return false;
+    }
+}
+
+struct Knob { const char* flag; const char* column; int SchedConfig::* field; int min; };
+const std::vector<Knob> KNOBS = {
+    {"--quantum",      "quantum",      &SchedConfig::quantum,      1},
+    {"--mlq-quantum",  "mlq_quantum",  &SchedConfig::mlq_quantum,  1},
+    {"--mlq-split",    "mlq_split",    &SchedConfig::mlq_split,    INT_MIN},
+    {"--mlfq-quantum", "mlfq_quantum", &SchedConfig::mlfq_quantum, 1},
+    {"--mlfq-levels",  "mlfq_levels",  &SchedConfig::mlfq_levels,  1},
+    {"--mlfq-age",     "mlfq_age",     &SchedConfig::mlfq_age,     1},
+    {"--mlfq-boost",   "mlfq_boost",   &SchedConfig::mlfq_boost,   0},
+    {"--cfs-latency",  "cfs_latency",  &SchedConfig::cfs_latency,  1},
+    {"--cfs-granularity", "cfs_granularity", &SchedConfig::cfs_granularity, 1},
+    {"--cpus",         "cpus",         &SchedConfig::cpus,         1},
+    {"--migrate-cost", "migrate_cost", &SchedConfig::migrate_cost, 0},
+    {"--switch-cost",  "switch_cost",  &SchedConfig::switch_cost,  0},
+    {"--warmup",       "warmup",       &SchedConfig::warmup,       0},
+};
+// which knobs (by flag) each scheduler actually reads
+static std::vector<std::string> policyKnobs(const std::string& sched) {
+    if (sched=="rr") return {"--quantum","--cpus","--migrate-cost"};
+    if (sched=="mlq") return {"--mlq-quantum","--mlq-split"};
+    if (sched=="mlfq") return {"--mlfq-quantum","--mlfq-levels","--mlfq-age","--mlfq-boost","--cpus","--migrate-cost"};
+    if (sched=="cfs") return {"--cfs-latency","--cfs-granularity","--cpus","--migrate-cost"};
+    return {};
+}
+static std::vector<std::string> knobsFor(const std::string& sched) {
+    std::vector<std::string> k = policyKnobs(sched);
+    k.insert(k.end(), {"--switch-cost","--warmup"});
+    return k;
+}
+
+// --sweep: expands the grid of every knob the chosen scheduler(s) read, runs
+// all configurations in parallel on the same workload and prints one CSV row each.
+int runSweep(const Workload& ps, const std::vector<std::string>& scheds,
+             const SchedConfig& base, std::map<std::string,std::string>& args) {
+    struct Config { std::string sched; SchedConfig cfg; std::vector<std::string> knobs; };
+    std::vector<Config> configs;
+    // a grid nobody reads, or one an explicit list overrides, would silently do nothing
+    for (auto& knob : KNOBS) {
+        auto it = args.find(knob.flag);
+        if (it == args.end() || it->second.empty()) continue;
+        bool read = false;
+        for (auto& sched : scheds) { auto k = knobsFor(sched); read |= std::find(k.begin(), k.end(), knob.flag) != k.end(); }
+        if (!read) { std::cerr<<knob.flag<<" is not read by any of the swept schedulers\n"; return 1; }
+        std::string flag = knob.flag;
+        if (!base.mlq_classes.empty() && (flag == "--mlq-quantum" || flag == "--mlq-split")) {
+            std::cerr<<"--mlq-classes overrides "<<flag<<"; sweep one or the other\n"; return 1;
+        }
+        if (!base.mlfq_quanta.empty() && (flag == "--mlfq-quantum" || flag == "--mlfq-levels")) {
+            std::cerr<<"--mlfq-quanta overrides "<<flag<<"; sweep one or the other\n"; return 1;
+        }
+    }
+    for (auto& sched : scheds) {
+        std::vector<Config> grid = { {sched, base, knobsFor(sched)} };
+        for (auto& knob : KNOBS) {
+            if (!args.count(knob.flag)) continue;
+            auto& used = grid[0].knobs;
+            if (std::find(used.begin(), used.end(), knob.flag) == used.end()) continue;
+            std::vector<int> values;
+            if (!parseGrid(args[knob.flag], values) || *std::min_element(values.begin(), values.end()) < knob.min) { std::cerr<<"Bad grid for "<<knob.flag<<": "<<args[knob.flag]<<"\n"; return 1; }
+            std::vector<Config> expanded;
+            for (auto& c : grid) for (int v : values) { Config e = c; e.cfg.*knob.field = v; expanded.push_back(e); }
+            grid.swap(expanded);
+        }
+        configs.insert(configs.end(), grid.begin(), grid.end());
+    }
+
+    struct Row { Metrics m; double ms; };
+    std::vector<Row> rows(configs.size());
+    parallelFor(configs.size(), [&](size_t k){
+        // each worker reuses one arena, so after its first configuration the
+        // schedulers run without touching the global heap
+        static thread_local RunArena arena;
+        arena.reserve(runFootprint(ps, false));
+        const SchedConfig& cfg = configs[k].cfg;
+        {
+            RunState st(arena.get()); int total_time = 0;
+            auto r0 = std::chrono::steady_clock::now();
+            if (cfg.cpus > 1) {
+                std::vector<Gantt> lanes;
+                for (int c = 0; c < cfg.cpus; ++c) lanes.emplace_back(nullptr, c);
+                SmpScheduler(configs[k].sched, cfg).schedule(ps, st, lanes, total_time);
+            } else {
+                Gantt gantt(nullptr);
+                makeScheduler(configs[k].sched, cfg)->schedule(ps, st, gantt, total_time);
+            }
+            Row& r = rows[k];
+            r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - r0).count();
+            r.m = calculateMetrics(ps, st, total_time, cfg.cpus);
+        }
+        arena.reset();
+    });
+
+    std::cout << "scheduler";
+    for (auto& knob : KNOBS) std::cout << "," << knob.column;
+    std::cout << ",avg_wait,avg_turnaround,avg_response,p99_wait,p99_turnaround,avg_slowdown,cpu_util,throughput,switches,switch_pct,runtime_ms\n";
+    for (size_t k = 0; k < configs.size(); ++k) {
+        const Config& c = configs[k]; const Row& r = rows[k];
+        std::cout << c.sched;
+        for (auto& knob : KNOBS) {
+            std::cout << ",";
+            if (std::find(c.knobs.begin(), c.knobs.end(), knob.flag) != c.knobs.end()) std::cout << c.cfg.*knob.field;
+        }
+        const Metrics& m = r.m;
+        std::cout << "," << m.wait.mean << "," << m.turnaround.mean << "," << m.response.mean << "," << m.wait.p99
+                  << "," << m.turnaround.p99 << "," << m.slowdown.mean << "," << m.cpu_util << "," << m.throughput
+                  << "," << m.switches << "," << m.switch_pct << "," << r.ms << "\n";
+    }
+    return 0;
+}
+
+// ---------- Gantt traces ----------
+// --trace FILE writes the Gantt chart as a compact binary stream while the
+// scheduler runs (or as trace-event JSON if FILE ends in .json, see below),
+// and --decode FILE turns a binary trace back into the text chart:
+//   TraceHeader | names (varint length + bytes, in handle order) | blocks...
+// A block is zigzag varint(sym - previous sym) then varint(length), with
+// sym = id + 1, 0 for IDLE and -1 for SWITCH, so neighbouring ids cost one byte each.
+struct TraceHeader {
+    char magic[8];
+    uint32_t version, reserved;
+    uint64_t names;
+};
+constexpr char TRACE_MAGIC[8] = {'S','C','H','E','D','T','R','\0'};
+constexpr uint32_t TRACE_VERSION = 1;
+
+// fopen'd file behind a 1 MB buffer, for the trace writers.
+class BufferedFile {
+    FILE* f = nullptr;
+    std::vector<char> buf = std::vector<char>(1 << 20);
+    size_t used = 0; bool ok = true;
+public:
+    uint64_t written = 0;
+    ~BufferedFile() { if (f) close(); }
+    bool open(const std::string& filename) {
+        f = fopen(filename.c_str(), "wb");
+        if (!f) std::cerr<<"Error opening file: "<<filename<<"\n";
+        return f != nullptr;
+    }
+    void flush() { if (used && fwrite(buf.data(), 1, used, f) != used) ok = false; written += used; used = 0; }
+    // room for `n` more bytes at cursor(); callers then advance()
+    char* reserve(size_t n) { if (buf.size() - used < n) flush(); if (buf.size() < n) buf.resize(n); return buf.data() + used; }
+    void advance(char* to) { used = to - buf.data(); }
+    void put(const void* p, size_t n) { char* c = reserve(n); memcpy(c, p, n); advance(c + n); }
+    void put(std::string_view sv) { put(sv.data(), sv.size()); }
+    bool close() {
+        flush();
+        if (fclose(f) != 0) ok = false;
+        f = nullptr;
+        return ok;
+    }
+};
+
+class TraceWriter : public GanttSink {
+    BufferedFile out; int64_t prev = 0;
+    void varint(uint64_t v) {
+        char* c = out.reserve(10);
+        while (v >= 0x80) { *c++ = char(uint8_t(v) | 0x80); v >>= 7; }
+        *c++ = char(v);
+        out.advance(c);
+    }
+public:
+    uint64_t written() const { return out.written; }
+    bool open(const std::string& filename, const IdTable& ids) {
+        if (!out.open(filename)) return false;
+        TraceHeader h{}; memcpy(h.magic, TRACE_MAGIC, 8); h.version = TRACE_VERSION; h.names = ids.size();
+        out.put(&h, sizeof h);
+        for (size_t i = 0; i < ids.size(); ++i) { auto nm = ids.name((ProcId)i); varint(nm.size()); out.put(nm); }
+        return true;
+    }
+    void block(int, ProcId id, int len) override {   // single CPU only (main checks)
+        int64_t sym = id == IDLE_ID ? 0 : id == SWITCH_ID ? -1 : (int64_t)id + 1, d = sym - prev;
+        prev = sym;
+        varint(((uint64_t)d << 1) ^ (uint64_t)(d >> 63));
+        varint((uint32_t)len);
+    }
+    bool close() { return out.close(); }
+};
+
+// --trace FILE.json: Chrome trace-event JSON for Perfetto / chrome://tracing.
+// One simulated time unit is one microsecond. Each CPU is a thread track with a
+// slice per block (idle is left as a gap), and every counter is a counter track
+// with one series per CPU; a sample is only written when its value changes.
+// Events are written as they arrive, so memory stays flat for any schedule length.
+class ChromeTraceWriter : public GanttSink {
+    BufferedFile out; const IdTable* ids = nullptr;
+    std::vector<int64_t> now;   // per-CPU clock; a CPU's track is named on first use
+    bool first = true;
+    struct Last { int cpu; const char* name; long long value; };
+    std::vector<Last> last;     // last value per (cpu, counter)
+    void sep() { out.put(first ? "\n" : ",\n"); first = false; }
+    void num(long long v) { char* c = out.reserve(24); out.advance(std::to_chars(c, c + 24, v).ptr); }
+    void str(std::string_view sv) {
+        char* c = out.reserve(sv.size() * 6 + 2);
+        *c++ = '"';
+        for (char ch : sv) {
+            if (ch == '"' || ch == '\\') { *c++ = '\\'; *c++ = ch; }
+            else if ((unsigned char)ch < 0x20) { c += snprintf(c, 7, "\\u%04x", ch); }
+            else *c++ = ch;
+        }
+        *c++ = '"';
+        out.advance(c);
+    }
+public:
+    uint64_t written() const { return out.written; }
+    bool open(const std::string& filename, const IdTable& table) {
+        if (!out.open(filename)) return false;
+        ids = &table;
+        out.put("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+        sep(); out.put("{\"ph\":\"M\",\"pid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"simulator\"}}");
+        return true;
+    }
+    void block(int cpu, ProcId id, int len) override {
+        if ((size_t)cpu >= now.size()) now.resize(cpu + 1, -1);
+        if (now[cpu] < 0) {
+            now[cpu] = 0;
+            sep(); out.put("{\"ph\":\"M\",\"pid\":0,\"tid\":"); num(cpu);
+            out.put(",\"name\":\"thread_name\",\"args\":{\"name\":\"CPU "); num(cpu); out.put("\"}}");
+        }
+        if (id != IDLE_ID) {
+            sep(); out.put("{\"ph\":\"X\",\"pid\":0,\"tid\":"); num(cpu); out.put(",\"ts\":"); num(now[cpu]);
+            out.put(",\"dur\":"); num(len); out.put(",\"name\":"); str(ids->name(id)); out.put("}");
+        }
+        now[cpu] += len;
+    }
+    void counter(int cpu, const char* name, int t, long long value) override {
+        auto it = std::find_if(last.begin(), last.end(), [&](const Last& e){ return e.cpu == cpu && e.name == name; });
+        if (it == last.end()) last.push_back({cpu, name, value});
+        else if (it->value == value) return;
+        else it->value = value;
+        sep(); out.put("{\"ph\":\"C\",\"pid\":0,\"ts\":"); num(t);
+        out.put(",\"name\":"); str(name); out.put(",\"args\":{\"cpu"); num(cpu); out.put("\":"); num(value); out.put("}}");
+    }
+    bool close() { out.put("\n]}\n"); return out.close(); }
+};
+
+int decodeTrace(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) { std::cerr<<"Error opening file: "<<filename<<"\n"; return 1; }
+    const uint8_t* p = (const uint8_t*)file.data();
+    const uint8_t* end = p + file.size();
+    const TraceHeader* h = (const TraceHeader*)p;
+    if (file.size() < sizeof(TraceHeader) || memcmp(h->magic, TRACE_MAGIC, 8) != 0 || h->version != TRACE_VERSION) {
+        std::cerr<<"Bad trace file: "<<filename<<"\n"; return 1;
+    }
+    p += sizeof(TraceHeader);
+    bool bad = false;
+    auto varint = [&]{
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) break;
+            uint8_t b = *p++;
+            v |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        bad = true; return v;
+    };
+    // every name costs at least its length byte, so a count past the remaining
+    // bytes is corrupt (and must not size the table)
+    if (h->names > (uint64_t)(end - p)) { std::cerr<<"Truncated or corrupt trace: "<<filename<<"\n"; return 1; }
+    std::vector<std::string_view> names(h->names);
+    for (auto& nm : names) {
+        uint64_t len = varint();
+        if (bad || len > (uint64_t)(end - p)) { bad = true; break; }
+        nm = std::string_view((const char*)p, len); p += len;
+    }
+    // decoded block by block, so the chart never has to fit in memory
+    int64_t sym = 0;
+    if (!bad) writeGantt(std::cout, [&](std::string_view& nm, int& len){
+        if (p == end) return false;
+        uint64_t z = varint(), l = varint();
+        sym += (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+        if (bad || sym < -1 || sym > (int64_t)names.size() || l > INT_MAX) { bad = true; return false; }
+        nm = sym == 0 ? std::string_view("IDLE") : sym < 0 ? std::string_view("SWITCH") : names[sym - 1]; len = (int)l;
+        return true;
+    });
+    if (bad) { std::cerr<<"Truncated or corrupt trace: "<<filename<<"\n"; return 1; }
+    return 0;
+}
+
+// ---------- Streaming mode ----------
+// --input -: arrival-ordered records on stdin are admitted as they are read and
+// the schedule is written as it is decided, one line per closed Gantt block
+// (`block NAME start length`) and per completion (`done NAME completion
+// turnaround waiting response`). Only jobs that have arrived and not finished
+// are held, so memory follows the ready queue rather than the trace length, and
+// time is 64-bit. Supports the policies that need nothing but the ready set:
+// fcfs, sjf, prio, srtf, rr and edf. --switch-cost/--warmup are charged as in
+// switchTo(), with one CPU, so a `block SWITCH` line precedes each switch.
+struct StreamJob {
+    std::string name;
+    long long arrival = 0, deadline = 0, response = -1;
+    long long left = -1;   // when it last left the CPU, -1 if it never ran
+    int burst = 0, priority = 0, remaining = 0;
+};
+
+// Ready set for one streaming policy; jobs are slots in the caller's table.
+class StreamPolicy {
+public:
+    virtual ~StreamPolicy() = default;
+    virtual void push(int slot) = 0;
+    virtual int pop() = 0;
+    virtual bool empty() const = 0;
+    virtual bool preemptive() const { return false; }          // re-pick at every arrival
+    virtual int quantum() const { return INT_MAX; }
+};
+
+class StreamFifo : public StreamPolicy {
+    std::queue<int> q; int slice;
+public:
+    explicit StreamFifo(int quantum = INT_MAX) : slice(quantum) {}
+    void push(int slot) override { q.push(slot); }
+    int pop() override { int s = q.front(); q.pop(); return s; }
+    bool empty() const override { return q.empty(); }
+    int quantum() const override { return slice; }
+};
+
+// Min-heap on key(job), ties by name, as in the batch schedulers.
+template <class Key>
+class StreamHeap : public StreamPolicy {
+    const std::vector<StreamJob>& jobs; Key key; bool preempt;
+    struct Later {
+        const StreamHeap* h;
+        bool operator()(int a, int b) const {
+            auto ka = h->key(h->jobs[a]), kb = h->key(h->jobs[b]);
+            if (ka != kb) return ka > kb;
+            return h->jobs[a].name > h->jobs[b].name;
+        }
+    };
+    std::priority_queue<int, std::vector<int>, Later> q;
+public:
+    StreamHeap(const std::vector<StreamJob>& j, Key k, bool preemptive) : jobs(j), key(k), preempt(preemptive), q(Later{this}) {}
+    void push(int slot) override { q.push(slot); }
+    int pop() override { int s = q.top(); q.pop(); return s; }
+    bool empty() const override { return q.empty(); }
+    bool preemptive() const override { return preempt; }
+};
+template <class Key>
+static std::unique_ptr<StreamPolicy> makeStreamHeap(const std::vector<StreamJob>& jobs, Key key, bool preemptive) {
+    return std::make_unique<StreamHeap<Key>>(jobs, key, preemptive);
+}
+
+// Lines from a file descriptor through a fixed buffer. `before_block` runs
+// before every read(), so output is flushed exactly when input would stall.
+class LineReader {
+    int fd; std::vector<char> buf; size_t head = 0, tail = 0; bool eof = false;
+    std::function<void()> before_block;
+public:
+    LineReader(int fd_, std::function<void()> f) : fd(fd_), buf(1 << 16), before_block(std::move(f)) {}
+    bool next(std::string& line) {
+        line.clear();
+        while (true) {
+            const char* b = buf.data() + head;
+            const char* nl = (const char*)memchr(b, '\n', tail - head);
+            if (nl) { line.append(b, nl - b); head += nl - b + 1; return true; }
+            line.append(b, tail - head); head = tail = 0;
+            if (eof) return !line.empty();
+            before_block();
+            ssize_t r = ::read(fd, buf.data(), buf.size());
+            if (r <= 0) eof = true; else tail = (size_t)r;
+        }
+    }
+};
+
+int runStream(const std::string& sched, const SchedConfig& cfg) {
+    std::vector<StreamJob> jobs;
+    std::vector<int> free_slots;
+    std::unique_ptr<StreamPolicy> policy;
+    if (sched=="fcfs") policy = std::make_unique<StreamFifo>();
+    else if (sched=="rr") policy = std::make_unique<StreamFifo>(cfg.quantum);
+    else if (sched=="sjf") policy = makeStreamHeap(jobs, [](const StreamJob& j){ return (long long)j.burst; }, false);
+    else if (sched=="prio" || sched=="priority") policy = makeStreamHeap(jobs, [](const StreamJob& j){ return (long long)j.priority; }, false);
+    else if (sched=="srtf") policy = makeStreamHeap(jobs, [](const StreamJob& j){ return (long long)j.remaining; }, true);
+    else if (sched=="edf") policy = makeStreamHeap(jobs, [](const StreamJob& j){ return j.deadline; }, true);
+    else { std::cerr<<"Streaming mode supports fcfs, sjf, prio, srtf, rr and edf\n"; return 1; }
+
+    std::ios::sync_with_stdio(false);
+    LineReader in(0, []{ std::cout.flush(); });
+    std::string line;
+    long long line_no = 0;
+    bool have_next = false, bad = false;
+    StreamJob next;
+    // reads the next record into `next`; false at end of input or on a bad line
+    auto readNext = [&]{
+        while (in.next(line)) {
+            ++line_no;
+            const char* p = line.data(); const char* end = p + line.size();
+            if (const char* h = (const char*)memchr(p, '#', end - p)) end = h;
+            auto blank = [](char c){ return c==' '||c=='\t'||c=='\r'; };
+            while (p < end && blank(*p)) ++p;
+            if (p == end) continue;
+            const char* id = p; while (p < end && !blank(*p)) ++p;
+            const char* id_end = p;
+            long long v[4]; int k = 0;
+            for (; k < 4; ++k) {
+                while (p < end && blank(*p)) ++p;
+                auto r = std::from_chars(p, end, v[k]);
+                if (r.ec != std::errc()) break;
+                p = r.ptr;
+            }
+            while (p < end && blank(*p)) ++p;
+            if (k < 3 || p != end || v[1] < 0 || v[1] > INT_MAX || (have_next && v[0] < next.arrival)) {
+                std::cerr<<"Bad or out-of-order record on line "<<line_no<<"\n"; bad = true; return false;
+            }
+            next.name.assign(id, id_end - id);
+            next.arrival = v[0]; next.burst = next.remaining = (int)v[1]; next.priority = (int)v[2];
+            next.deadline = (k == 4 && v[3]) ? v[3] : v[0] + 2 * v[1];
+            next.response = -1; next.left = -1;
+            return true;
+        }
+        return false;
+    };
+    have_next = readNext();
+
+    long long t = 0, count = 0, busy = 0;
+    int last = -1;                               // slot the CPU ran last, -1 after a completion
+    long long switches = 0, switch_time = 0;
+    double sum_wait = 0, sum_turn = 0, sum_resp = 0, sum_slow = 0;
+    int open = -1; long long open_start = 0;    // block being extended
+    auto closeBlock = [&]{
+        if (open >= 0 && t > open_start) std::cout << "block " << jobs[open].name << " " << open_start << " " << t - open_start << "\n";
+        open = -1;
+    };
+    auto admit = [&]{
+        while (have_next && next.arrival <= t) {
+            int slot;
+            if (free_slots.empty()) { slot = (int)jobs.size(); jobs.push_back(next); }
+            else { slot = free_slots.back(); free_slots.pop_back(); jobs[slot] = next; }
+            policy->push(slot);
+            have_next = readNext();
+        }
+    };
+    while (!bad) {
+        admit();
+        if (policy->empty()) {
+            if (!have_next) break;
+            closeBlock();
+            if (next.arrival > t) std::cout << "block IDLE " << t << " " << next.arrival - t << "\n";
+            t = next.arrival;
+            continue;
+        }
+        int j = policy->pop();
+        StreamJob* job = &jobs[j];
+        if (last != j) {
+            last = j; ++switches;
+            long long over = cfg.switch_cost;
+            if (cfg.warmup > 0) over += job->left < 0 ? cfg.warmup : std::min<long long>(cfg.warmup, t - job->left);
+            if (over > 0) {
+                closeBlock();
+                std::cout << "block SWITCH " << t << " " << over << "\n";
+                t += over; switch_time += over;
+            }
+        }
+        if (job->response < 0) job->response = t - job->arrival;
+        if (open != j) { closeBlock(); open = j; open_start = t; }
+        long long run = std::min(job->remaining, policy->quantum());
+        if (policy->preemptive() && have_next) run = std::min(run, std::max(0LL, next.arrival - t));
+        job->remaining -= (int)run; t += run;
+        admit();                  // may grow the table
+        job = &jobs[j];
+        job->left = t;
+        if (job->remaining > 0) { policy->push(j); continue; }
+        closeBlock(); last = -1;
+        long long turn = t - job->arrival, wait = turn - job->burst;
+        std::cout << "done " << job->name << " " << t << " " << turn << " " << wait << " " << job->response << "\n";
+        ++count; busy += job->burst;
+        sum_wait += wait; sum_turn += turn; sum_resp += job->response; sum_slow += (double)turn / std::max(job->burst, 1);
+        free_slots.push_back(j);
+    }
+    closeBlock();
+    if (bad) return 1;
+    if (count == 0) { std::cerr<<"No processes loaded.\n"; return 1; }
+    std::cout << "Average Waiting Time: "    << sum_wait / count << "\n";
+    std::cout << "Average Turnaround Time: " << sum_turn / count << "\n";
+    std::cout << "CPU Utilization: "         << (t ? (double)busy / t * 100.0 : 0.0) << "%\n";
+    std::cout << "Throughput: "              << (t ? (double)count / t : 0.0) << " processes/unit time\n";
+    std::cout << "Average Response Time: "   << sum_resp / count << "\n";
+    std::cout << "Average Slowdown: "        << sum_slow / count << "\n";
+    std::cout << "Context Switches: "        << switches << "\n";
+    std::cout << "Switch Overhead: "         << (t ? (double)switch_time / t * 100.0 : 0.0) << "% of CPU time\n";
+    std::cerr << "Streamed " << count << " processes, peak " << jobs.size() << " active\n";
+    return 0;
+}
+
 // ---------- Main ----------
+// sched_bench.cpp includes this file with SIMULATOR_NO_MAIN defined.
+#ifndef SIMULATOR_NO_MAIN
 int main(int argc, char* argv[]) {
     std::map<std::string,std::string> args;
     for (int i = 1; i + 1 < argc; i += 2) args[argv[i]] = argv[i + 1];
     std::string sched = args["--scheduler"];
     std::string input = args["--input"];
-    int quantum = args["--quantum"].empty()? 4 : std::stoi(args["--quantum"]);
+    if (!args["--threads"].empty()) g_threads = (unsigned)std::stoul(args["--threads"]);
+    bool stats = args["--stats"] == "1";
+    bool perf_on = args["--perf"] == "1";
+#ifndef SIM_STATS
+    if (stats) { std::cerr<<"--stats needs a build with -DSIM_STATS\n"; return 1; }
+#endif
     bool random = args.count("--random");
+    // --seed drives both the generator and the lottery draws; without it both use the clock
+    uint64_t seed = args["--seed"].empty() ? (uint64_t)std::chrono::system_clock::now().time_since_epoch().count()
+                                           : std::stoull(args["--seed"]);
+    bool lottery = sched == "all" || sched.find("lottery") != std::string::npos;
+    if (args["--seed"].empty() && (random || lottery)) std::cerr<<"Random seed: "<<seed<<"\n";
+    GenSpec gen;
+    if (random) {
+        gen.n = std::stoll(args["--random"]);
+        gen.seed = seed;
+        if (!args["--arrival"].empty()) gen.arrival = args["--arrival"];
+        if (!args["--burst"].empty()) gen.burst = args["--burst"];
+        if (!args["--rate"].empty()) gen.rate = std::stod(args["--rate"]);
+        if (!args["--mean-burst"].empty()) gen.mean_burst = std::stod(args["--mean-burst"]);
+        if (!args["--io-bursts"].empty()) gen.io_bursts = std::stoi(args["--io-bursts"]);
+        if (!args["--mean-io"].empty()) gen.mean_io = std::stod(args["--mean-io"]);
+        if (!WorkloadGenerator::valid(gen)) { std::cerr<<"Bad --random/--arrival/--burst/--rate/--mean-burst/--io-bursts/--mean-io\n"; return 1; }
+        if (args.count("--emit")) return emitRandomProcesses(gen, args["--emit"]) ? 0 : 1;
+    }
+    bool sweep = args.count("--sweep");
+    SchedConfig cfg;
+    cfg.seed = seed;
+    if (!args["--tickets"].empty()) cfg.tickets = std::stoll(args["--tickets"]);
+    if (cfg.tickets < 1) { std::cerr<<"--tickets must be at least 1\n"; return 1; }
+    if (!args["--mlq-classes"].empty() && !parseMlqClasses(args["--mlq-classes"], cfg.mlq_classes)) {
+        std::cerr<<"Bad --mlq-classes (expected e.g. 3:rr/4,6:sjf,fcfs)\n"; return 1;
+    }
+    if (!args["--mlfq-quanta"].empty()) {
+        if (!parseGrid(args["--mlfq-quanta"], cfg.mlfq_quanta)) { std::cerr<<"Bad --mlfq-quanta (expected e.g. 2,4,8)\n"; return 1; }
+        for (int qv : cfg.mlfq_quanta) if (qv < 1) { std::cerr<<"--mlfq-quanta values must be at least 1\n"; return 1; }
+    }
+    if (!sweep)
+        for (auto& knob : KNOBS) {
+            if (args[knob.flag].empty()) continue;
+            const std::string& v = args[knob.flag];
+            auto r = std::from_chars(v.data(), v.data() + v.size(), cfg.*knob.field);
+            if (r.ec != std::errc() || r.ptr != v.data() + v.size()) { std::cerr<<"Bad "<<knob.flag<<": "<<v<<"\n"; return 1; }
+            if (cfg.*knob.field < knob.min) { std::cerr<<knob.flag<<" must be at least "<<knob.min<<"\n"; return 1; }
+        }
+
+    if (args.count("--bench")) {
+        if (sched.empty()) sched = "edf";
+        if (!makeScheduler(sched, cfg)) { std::cerr<<"Unknown scheduler: "<<sched<<"\n"; return 1; }
+        int max_n = std::stoi(args["--bench"]);
+        if (cfg.tickets > LotteryScheduler::maxScale(std::max(max_n, 0))) { std::cerr<<"--tickets must be at most "<<LotteryScheduler::maxScale(std::max(max_n, 0))<<" for "<<max_n<<" jobs\n"; return 1; }
+        return runBench(sched, cfg, max_n);
+    }
+
+    if (args.count("--bench-layout")) return runLayoutBench(std::stoll(args["--bench-layout"]));
+    if (input == "-") return runStream(sched, cfg);
+    if (args.count("--decode")) return decodeTrace(args["--decode"]);
 
-    std::vector<Process> processes;
-    if (random) processes = generateRandomProcesses(10);
-    else if (!input.empty()) processes = loadProcesses(input);
-    else {
-        processes = { {"P1",0,8,2}, {"P2",1,4,1}, {"P3",2,9,3}, {"P4",3,5,4} };
+    BinaryWorkload bin;
+    std::pmr::monotonic_buffer_resource name_arena;   // interned names, freed with the table
+    IdTable ids(&name_arena);
+    Workload processes;
+    {
+        SIM_PHASE(load);
+        if (random) processes = generateRandomProcesses(gen, ids);
+        else if (!input.empty() && isBinaryWorkload(input)) {
+            auto t0 = std::chrono::steady_clock::now();
+            if (bin.open(input, ids)) {
+                processes = bin.view();
+                std::cerr << "Mapped " << bin.size() << " processes in "
+                          << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() << " ms\n";
+            }
+        }
+        else if (!input.empty()) processes = loadProcesses(input, ids);
+        else {
+            for (Process p : { Process{ids.intern("P1"),0,8,2}, Process{ids.intern("P2"),1,4,1},
+                               Process{ids.intern("P3"),2,9,3}, Process{ids.intern("P4"),3,5,4} })
+                processes.push_back(p);
+            ids.finalize(processes);
+        }
     }
     if (processes.empty()) { std::cerr<<"No processes loaded.\n"; return 1; }
+    if (cfg.tickets > LotteryScheduler::maxScale(processes.size())) {
+        std::cerr<<"--tickets must be at most "<<LotteryScheduler::maxScale(processes.size())<<" for "<<processes.size()<<" jobs\n"; return 1;
+    }
 
-    std::unique_ptr<Scheduler> scheduler;
-    if (sched=="fcfs") scheduler = std::make_unique<FCFSScheduler>();
-    else if (sched=="sjf") scheduler = std::make_unique<SJFScheduler>();
-    else if (sched=="srtf") scheduler = std::make_unique<SRTFScheduler>();
-    else if (sched=="prio" || sched=="priority") scheduler = std::make_unique<PriorityScheduler>();
-    else if (sched=="rr") scheduler = std::make_unique<RoundRobinScheduler>(quantum);
-    else if (sched=="mlq") scheduler = std::make_unique<MLQScheduler>();
-    else if (sched=="mlfq") scheduler = std::make_unique<MLFQScheduler>();
-    else if (sched=="lottery") scheduler = std::make_unique<LotteryScheduler>();
-    else if (sched=="cfs") scheduler = std::make_unique<CFSScheduler>();
-    else if (sched=="edf") scheduler = std::make_unique<EDFScheduler>();
-    else { std::cerr<<"Unknown scheduler: "<<sched<<"\n"; return 1; }
-
-    std::vector<std::pair<std::string,int>> gantt;
+    if (args.count("--convert")) return writeBinaryWorkload(args["--convert"], processes, ids) ? 0 : 1;
+
+    // one chart per run: `all` and --sweep print tables and would drop the trace
+    if (!args["--trace"].empty() && (sweep || sched == "all")) { std::cerr<<"--trace needs a single --scheduler run\n"; return 1; }
+    if (sweep) {
+        std::vector<std::string> scheds;
+        if (sched == "all") scheds = ALL_SCHEDULERS;
+        else for (size_t pos = 0; pos <= sched.size(); ) {
+            size_t comma = std::min(sched.find(',', pos), sched.size());
+            scheds.push_back(sched.substr(pos, comma - pos)); pos = comma + 1;
+        }
+        for (auto& name : scheds) if (!makeScheduler(name)) { std::cerr<<"Unknown scheduler: "<<name<<"\n"; return 1; }
+        return runSweep(processes, scheds, cfg, args);
+    }
+    if (cfg.cpus > 1 && !SmpScheduler::supports(sched)) { std::cerr<<"--cpus needs --scheduler rr, cfs or mlfq\n"; return 1; }
+    if (sched == "all") return runAll(processes, cfg);
+
+    std::unique_ptr<Scheduler> scheduler = makeScheduler(sched, cfg);
+    if (!scheduler) { std::cerr<<"Unknown scheduler: "<<sched<<"\n"; return 1; }
+
+    // --trace streams the chart to a file; --gantt 0 drops it. Either way the
+    // blocks are not kept and the text chart is not printed.
+    std::string trace_file = args["--trace"];
+    bool json = trace_file.size() > 5 && trace_file.compare(trace_file.size() - 5, 5, ".json") == 0;
+    TraceWriter trace; ChromeTraceWriter chrome;
+    bool keep_chart = trace_file.empty() && args["--gantt"] != "0";
+    // the run's RunState, queues and kept Gantt blocks, sized so the run allocates nothing
+    RunArena arena(runFootprint(processes, keep_chart));
+    size_t chart_blocks = cpuBursts(processes) * GANTT_BLOCKS_PER_BURST;
+    std::unique_ptr<Gantt> chart = std::make_unique<Gantt>(arena.get());
+    if (cfg.cpus > 1) {
+        if (!trace_file.empty() && !json) { std::cerr<<"--cpus traces need a .json file\n"; return 1; }
+        if (json && !chrome.open(trace_file, ids)) return 1;
+        std::vector<Gantt> lanes;
+        for (int c = 0; c < cfg.cpus; ++c) {
+            if (json) lanes.emplace_back(&chrome, c);
+            else if (args["--gantt"] == "0") lanes.emplace_back(nullptr, c);
+            else { lanes.emplace_back(arena.get()); lanes.back().reserve(chart_blocks / cfg.cpus); }
+        }
+        RunState st(arena.get()); int total_time = 0;
+        SmpStats smp{std::pmr::vector<long long>(arena.get())};   // same arena, so the result moves in
+        PerfGroup perf;
+        if (perf_on) perf.open();
+        {
+            SIM_PHASE(schedule);
+            perf.start();
+            smp = SmpScheduler(sched, cfg).schedule(processes, st, lanes, total_time);
+            perf.stop();
+        }
+        if (json) {
+            if (!chrome.close()) { std::cerr<<"Error writing file: "<<trace_file<<"\n"; return 1; }
+            size_t blocks = 0; for (auto& lane : lanes) blocks += lane.size();
+            std::cerr << "Wrote " << blocks << " blocks to " << trace_file << " (" << chrome.written() / 1e6 << " MB)\n";
+        }
+        {
+            SIM_PHASE(print);
+            for (int c = 0; c < cfg.cpus; ++c)
+                if (lanes[c].stored()) { std::cout << "CPU " << c << " "; printGantt(lanes[c], ids); }
+            printMetrics(processes, st, total_time, cfg.cpus);
+            for (int c = 0; c < cfg.cpus; ++c)
+                std::cout << "CPU " << c << " Utilization: " << (total_time ? (double)smp.busy[c] / total_time * 100.0 : 0.0) << "%\n";
+            std::cout << "Migrations: " << smp.migrations << "\n";
+        }
+        if (perf_on) { size_t blocks = 0; for (auto& lane : lanes) blocks += lane.size(); printPerf(perf, blocks); }
+        if (stats) printStats();
+        return 0;
+    }
+    if (!trace_file.empty()) {
+        if (json ? !chrome.open(trace_file, ids) : !trace.open(trace_file, ids)) return 1;
+        chart = std::make_unique<Gantt>(json ? (GanttSink*)&chrome : &trace);
+    }
+    else if (args["--gantt"] == "0") chart = std::make_unique<Gantt>(nullptr);
+    Gantt& gantt = *chart;
+    gantt.reserve(chart_blocks);
+
+    RunState st(arena.get());
     int total_time = 0;
-    scheduler->schedule(processes, gantt, total_time);
-    printResults(processes, total_time, gantt);
+    PerfGroup perf;
+    if (perf_on) perf.open();
+    {
+        SIM_PHASE(schedule);
+        perf.start();
+        scheduler->schedule(processes, st, gantt, total_time);
+        perf.stop();
+    }
+    if (!trace_file.empty()) {
+        if (json ? !chrome.close() : !trace.close()) { std::cerr<<"Error writing file: "<<trace_file<<"\n"; return 1; }
+        std::cerr << "Wrote " << gantt.size() << " blocks to " << trace_file << " ("
+                  << (json ? chrome.written() : trace.written()) / 1e6 << " MB)\n";
+    }
+    { SIM_PHASE(print); printResults(processes, st, total_time, gantt, ids); }
+    if (perf_on) printPerf(perf, gantt.size());
+    if (stats) printStats();
     return 0;
 }
+#endif // SIMULATOR_NO_MAIN
@@ -0,0 +1,89 @@
+#!/bin/sh
+# Regression tests for the simulator CLI. Builds simulator.cpp into a scratch
+# directory and checks exit codes and output of a few fixed cases.
+#   sh tests/regress.sh
+set -u
+root=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+g++ -std=c++17 -O2 -Wall -pthread "$root/simulator.cpp" -o "$tmp/sim" || exit 1
+sim="$tmp/sim"
+fails=0
+ok() { echo "ok   $1"; }
+fail() { echo "FAIL $1"; fails=$((fails+1)); }
+
+# A binary workload whose id column points past the name table is rejected
+# instead of being read out of bounds.
+printf 'P1 0 8 2\nP2 1 4 1\nP3 2 9 3\n' > "$tmp/w.txt"
+"$sim" --input "$tmp/w.txt" --convert "$tmp/w.bin" 2>/dev/null
+cp "$tmp/w.bin" "$tmp/bad.bin"
+off_id=$(od -An -tu8 -j48 -N8 "$tmp/w.bin" | tr -d ' ')
+printf '\377\377\377\177' | dd of="$tmp/bad.bin" bs=1 seek=$((off_id + 4)) conv=notrunc 2>/dev/null
+"$sim" --input "$tmp/w.bin" --scheduler fcfs >/dev/null 2>&1 && ok "binary workload loads" || fail "binary workload loads"
+"$sim" --input "$tmp/bad.bin" --scheduler fcfs > "$tmp/out" 2>&1
+rc=$?
+if [ $rc -eq 1 ] && grep -q "Bad binary workload" "$tmp/out"; then ok "corrupt id column rejected"; else fail "corrupt id column rejected (rc=$rc)"; fi
+
+# A trace whose header claims more names than the file has bytes is reported as
+# corrupt, not turned into a huge allocation.
+"$sim" --scheduler rr --trace "$tmp/t.trace" >/dev/null 2>&1
+cp "$tmp/t.trace" "$tmp/bad.trace"
+printf '\377\377\377\377\377\377\377\177' | dd of="$tmp/bad.trace" bs=1 seek=16 conv=notrunc 2>/dev/null
+"$sim" --decode "$tmp/t.trace" >/dev/null 2>&1 && ok "trace decodes" || fail "trace decodes"
+"$sim" --decode "$tmp/bad.trace" > "$tmp/out" 2>&1
+rc=$?
+if [ $rc -eq 1 ] && grep -q "corrupt trace" "$tmp/out"; then ok "corrupt trace name count rejected"; else fail "corrupt trace name count rejected (rc=$rc)"; fi
+
+# --trace writes one run's chart, so `all` refuses it instead of ignoring it.
+"$sim" --scheduler all --trace "$tmp/all.trace" > "$tmp/out" 2>&1
+rc=$?
+if [ $rc -eq 1 ] && [ ! -e "$tmp/all.trace" ]; then ok "--scheduler all refuses --trace"; else fail "--scheduler all refuses --trace (rc=$rc)"; fi
+
+# --tickets is bounded so the lottery's ticket sums cannot overflow.
+"$sim" --scheduler lottery --tickets 9223372036854775807 >/dev/null 2>&1 && fail "huge --tickets refused" || ok "huge --tickets refused"
+"$sim" --scheduler lottery --tickets -1 >/dev/null 2>&1 && fail "negative --tickets refused" || ok "negative --tickets refused"
+
+# The lottery is seeded from --seed, so a seeded run is reproducible.
+a=$("$sim" --scheduler lottery --seed 1 2>/dev/null)
+b=$("$sim" --scheduler lottery --seed 1 2>/dev/null)
+[ -n "$a" ] && [ "$a" = "$b" ] && ok "lottery --seed reproducible" || fail "lottery --seed reproducible"
+
+# An idle gap gets its own IDLE block instead of being merged into the
+# previous job's block (batch rr and mlq).
+printf 'A 0 2 1\nB 5 2 1\n' > "$tmp/gap.txt"
+for s in rr mlq; do
+    "$sim" --input "$tmp/gap.txt" --scheduler $s 2>/dev/null | grep -qF "(A 2) (IDLE 3) (B 2)" \
+        && ok "$s idle gap is its own block" || fail "$s idle gap is its own block"
+done
+
+# Streaming mode charges --switch-cost/--warmup like the batch schedulers.
+printf 'P1 0 8 2\nP2 1 4 1\nP3 2 9 3\nP4 3 5 4\n' > "$tmp/d.txt"
+for s in fcfs rr srtf; do
+    a=$("$sim" --input "$tmp/d.txt" --scheduler $s --switch-cost 1 --warmup 2 2>/dev/null | grep -E "^(Average (Waiting|Turnaround)|Context Switches|Switch Overhead)")
+    b=$("$sim" --input - --scheduler $s --switch-cost 1 --warmup 2 < "$tmp/d.txt" 2>/dev/null | grep -E "^(Average (Waiting|Turnaround)|Context Switches|Switch Overhead)")
+    [ -n "$a" ] && [ "$a" = "$b" ] && ok "$s stream switch cost matches batch" || fail "$s stream switch cost matches batch"
+done
+
+# A boost that comes due during a context switch reaches the job being
+# switched in: A is dispatched from level 1 at t=6, the boost at t=7 lands in
+# its switch, so it runs a level-0 slice (2) instead of a level-1 one (4).
+printf 'A 0 30 1\nB 0 30 1\n' > "$tmp/boost.txt"
+"$sim" --input "$tmp/boost.txt" --scheduler mlfq --switch-cost 1 --mlfq-boost 7 --mlfq-age 100 2>/dev/null \
+    | grep -qF "Gantt Chart: (SWITCH 1) (A 2) (SWITCH 1) (B 2) (SWITCH 1) (A 2) (SWITCH 1) (B 2) " \
+    && ok "mlfq boost during a switch" || fail "mlfq boost during a switch"
+
+# Bad sweep grids are reported, not thrown, wrapped or looped on.
+for g in x 2,4, 1:4x 2147483600:2147483647:100 2147483647:2147483647; do
+    out=$(timeout 10 "$sim" --sweep 1 --scheduler rr --quantum "$g" 2>&1)
+    rc=$?
+    case "$g" in
+        2147483*) [ $rc -eq 0 ] && [ $(printf '%s\n' "$out" | grep -c '^rr,') -eq 1 ] ;;
+        *) [ $rc -eq 1 ] && printf '%s\n' "$out" | grep -q "Bad grid for --quantum" ;;
+    esac && ok "sweep grid '$g'" || fail "sweep grid '$g' (rc=$rc)"
+done
+# A grid no swept scheduler reads, or one --mlq-classes overrides, is an error.
+"$sim" --sweep 1 --scheduler fcfs --quantum 1:3 >/dev/null 2>&1 && fail "unread sweep knob refused" || ok "unread sweep knob refused"
+"$sim" --sweep 1 --scheduler mlq --mlq-classes 3:rr/4,fcfs --mlq-quantum 1:3 >/dev/null 2>&1 \
+    && fail "--mlq-classes with an mlq grid refused" || ok "--mlq-classes with an mlq grid refused"
+
+[ $fails -eq 0 ] || { echo "$fails failed"; exit 1; }